@@ -2,6 +2,7 @@
 
 #include "PluginProcessor.h"
 #include "ResonatorVoice.h"
+#include <melatonin_perfetto/melatonin_perfetto.h>
 
 void ImpulseExciter::prepare(const juce::dsp::ProcessSpec& spec)
 {
@@ -15,6 +16,7 @@ void ImpulseExciter::prepare(const juce::dsp::ProcessSpec& spec)
 
 void ImpulseExciter::process(juce::dsp::AudioBlock<float>& exciterBlock, juce::dsp::AudioBlock<float>& outputBlock)
 {
+    TRACE_DSP();
     jassert(exciterBlock.getNumChannels() == 2);
     if (!params.enabled->isOn()) return;
 
@@ -72,6 +74,7 @@ void NoiseExciter::prepare(const juce::dsp::ProcessSpec& spec)
 
 void NoiseExciter::process(juce::dsp::AudioBlock<float>& exciterBlock, juce::dsp::AudioBlock<float>& outputBlock)
 {
+    TRACE_DSP();
     jassert(exciterBlock.getNumChannels() == 2);
     if (!params.enabled->isOn()) return;
 
@@ -133,6 +136,7 @@ void SequenceExciter::prepare(const juce::dsp::ProcessSpec& spec)
 
 void SequenceExciter::process(juce::dsp::AudioBlock<float>& exciterBlock, juce::dsp::AudioBlock<float>& outputBlock)
 {
+    TRACE_DSP();
     if (!params.enabled->isOn()) return;
 
     juce::dsp::AudioBlock<float> truncatedBlock = scratchBlock.getSubBlock(0, (size_t)exciterBlock.getNumSamples());
@@ -319,6 +323,7 @@ void SampleExciter::prepare(const juce::dsp::ProcessSpec& spec)
 
 void SampleExciter::process(juce::dsp::AudioBlock<float>& exciterBlock, juce::dsp::AudioBlock<float>& outputBlock)
 {
+    TRACE_DSP();
     if (!params.enabled->isOn() || !state.sampler.isLoaded() || !isPlaying)
         return;
 
@@ -424,6 +429,7 @@ void ExternalInputExciter::prepare(const juce::dsp::ProcessSpec& spec)
 void ExternalInputExciter::process(juce::dsp::AudioBlock<float>& exciterBlock,
                                    juce::dsp::AudioBlock<float>& outputBlock)
 {
+    TRACE_DSP();
     if (!params.enabled->isOn()) return;
 
     const auto& v = dynamic_cast<ResonatorVoice&>(this->voice);
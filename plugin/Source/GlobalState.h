@@ -3,7 +3,13 @@
 
 #include <gin_plugin/gin_plugin.h>
 #include "defines.h"
+#include "dsp/DelayLineArena.h"
 #include "dsp/Sampler.h"
+#include "util/ModRouting.h"
+#include "util/RealtimeThreadPool.h"
+#include "util/StageProfiler.h"
+
+class ImpulseResponseBaker;
 
 /**
 (A reference to) this struct is passed down to all components that require global state information,
@@ -18,6 +24,7 @@ public:
     GlobalState() = default;
     ~GlobalState() = default;
     gin::ModMatrix modMatrix;
+    ModRouting modRouting; //which parameters have poly modulation routed to them, see ModRouting
     gin::ModSrcId modSrcPressure;
     gin::ModSrcId modSrcTimbre;
     gin::ModSrcId modSrcPitchbend;
@@ -41,8 +48,19 @@ public:
     int soloBankIndex = 0;
     int soloResonatorIndex = 0;
     bool polyFX = false;
+    bool multithreaded = false; //render voices, and independent resonator banks within a voice, on the thread pool
+    bool bakeResonators = false; //replace static PARALLEL banks with their impulse response, see ImpulseResponseBaker
     juce::AudioPlayHead* playHead;
     juce::AudioBuffer<float> extInputBuffer;
+    //spawned off the audio thread once multithreaded rendering is first needed, see ResonariumProcessor::createThreadPool();
+    //the audio thread only reads threadPool, which is published once the pool is ready
+    std::unique_ptr<RealtimeThreadPool> threadPoolStorage;
+    std::atomic<RealtimeThreadPool*> threadPool { nullptr };
+    std::unique_ptr<ImpulseResponseBaker> impulseResponseBaker; //created in prepareToPlay, except when headless
+    DelayLineArena delayLineArena; //storage for the delay lines of every enabled resonator, in every voice
+    //indexed by bankIndex * NUM_RESONATORS + resonatorIndex; set once every voice's copy of that resonator has delay line storage
+    std::array<std::atomic<bool>, NUM_RESONATOR_BANKS * NUM_RESONATORS> resonatorMemoryReady {};
+    StageProfiler profiler; //how long each stage of rendering takes per block, see StageProfiler
 };
 
 
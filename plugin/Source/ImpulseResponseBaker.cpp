@@ -0,0 +1,427 @@
+#include "ImpulseResponseBaker.h"
+#include "WaveguideResonatorBank.h"
+
+namespace
+{
+    constexpr float audibleThreshold = 1.0e-4f; //-80 dB below the peak; the response is cut after its last louder sample
+    constexpr int timingBlockSize = 64;
+    constexpr int timingLength = 2 * PartitionedConvolver::maxBlockSize; //long enough to include the largest stages
+    constexpr double requiredSpeedup = 2.0; //the convolution must be at least this much faster than the live loops
+}
+
+ImpulseResponseBaker::ImpulseResponseBaker() : juce::Thread("Resonator Baker")
+{
+}
+
+ImpulseResponseBaker::~ImpulseResponseBaker()
+{
+    stop();
+}
+
+void ImpulseResponseBaker::prepare(double newSampleRate)
+{
+    stop();
+    for (auto& slot : cache)
+    {
+        jassert(slot.users.load() == 0);
+        slot.response.reset();
+        slot.key.store(0);
+        slot.status.store(slotEmpty);
+    }
+    for (auto& job : jobs)
+    {
+        job.resonators.clear();
+        job.status.store(jobFree);
+    }
+
+    sampleRate = newSampleRate;
+    maxLength = static_cast<int>(std::ceil(maxLengthInSeconds * sampleRate));
+    channelStateSize = PartitionedConvolver::ImpulseResponse::getMaxStateSize(maxLength);
+    stateMemory.allocate(static_cast<size_t>(numStateSlots) * 2 * channelStateSize, true);
+    for (auto& inUse : stateSlotsInUse)
+    {
+        inUse.store(false);
+    }
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void ImpulseResponseBaker::stop()
+{
+    signalThreadShouldExit();
+    wakeUps.fetch_add(1, std::memory_order_release);
+    wakeUps.notify_all();
+    stopThread(4000);
+}
+
+ImpulseResponseBaker::Key ImpulseResponseBaker::getKey(const WaveguideResonatorBank& bank) noexcept
+{
+    //FNV-1a, a word at a time, over every coefficient that the impulse response depends on
+    Key hash = 14695981039346656037ull;
+    auto add = [&hash](float value)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hash = (hash ^ bits) * 1099511628211ull;
+    };
+
+    add(bank.sampleRate);
+    for (int j = 0; j < NUM_RESONATORS; j++)
+    {
+        const auto* r = bank.resonators[j];
+        if (!r->enabled) continue;
+        add(static_cast<float>(j));
+        for (const auto& resonator : r->resonators)
+        {
+            add(resonator.passthrough ? 1.0f : 0.0f);
+            add(resonator.gain);
+            add(resonator.decayCoefficient);
+            add(resonator.delayLengthInSamples);
+            add(resonator.loopFilter.cutoff);
+            add(resonator.loopFilter.q);
+            add(resonator.loopFilter.mode);
+            add(resonator.apf.c);
+            add(resonator.apf.s);
+            add(resonator.postFilterCutoff);
+            add(resonator.postFilterResonance);
+            add(resonator.postFilterMode);
+        }
+    }
+    return hash == 0 ? 1 : hash; //0 marks an empty cache slot
+}
+
+ImpulseResponseBaker::Lease ImpulseResponseBaker::acquire(Key key, bool& rejected) noexcept
+{
+    rejected = false;
+    for (int i = 0; i < numCacheSlots; i++)
+    {
+        auto& slot = cache[static_cast<size_t>(i)];
+        if (slot.key.load() != key) continue;
+
+        const int status = slot.status.load();
+        if (status == slotRejected)
+        {
+            rejected = true;
+            return {};
+        }
+        if (status != slotReady) continue;
+
+        //the slot may be evicted between the check above and this point; insert() backs off if it sees a user,
+        //and this backs off if the eviction got there first
+        slot.users.fetch_add(1);
+        if (slot.status.load() == slotReady && slot.key.load() == key)
+        {
+            slot.lastUsed.store(useClock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+            return {slot.response.get(), i};
+        }
+        slot.users.fetch_sub(1);
+    }
+    return {};
+}
+
+void ImpulseResponseBaker::release(Lease& lease) noexcept
+{
+    if (lease.response == nullptr) return;
+    cache[static_cast<size_t>(lease.slot)].users.fetch_sub(1);
+    lease = {};
+}
+
+void ImpulseResponseBaker::requestBake(Key key, const WaveguideResonatorBank& bank) noexcept
+{
+    for (auto& job : jobs)
+    {
+        const int status = job.status.load(std::memory_order_acquire);
+        if ((status == jobQueued || status == jobBaking) && job.key == key) return;
+    }
+
+    for (auto& job : jobs)
+    {
+        int expected = jobFree;
+        if (!job.status.compare_exchange_strong(expected, jobFilling, std::memory_order_acquire)) continue;
+
+        job.key = key;
+        job.resonators.clear();
+        for (const auto* r : bank.resonators)
+        {
+            if (!r->enabled) continue;
+            job.resonators.add(r->resonators[0]);
+            job.resonators.add(r->resonators[1]);
+        }
+        job.status.store(jobQueued, std::memory_order_release);
+        wakeUps.fetch_add(1, std::memory_order_release);
+        wakeUps.notify_one();
+        return;
+    }
+}
+
+float* ImpulseResponseBaker::acquireState() noexcept
+{
+    for (int i = 0; i < numStateSlots; i++)
+    {
+        bool expected = false;
+        if (stateSlotsInUse[static_cast<size_t>(i)].compare_exchange_strong(expected, true))
+        {
+            return stateMemory.get() + static_cast<size_t>(i) * 2 * channelStateSize;
+        }
+    }
+    return nullptr;
+}
+
+void ImpulseResponseBaker::releaseState(float* memory) noexcept
+{
+    const auto slot = static_cast<size_t>(memory - stateMemory.get()) / (2 * channelStateSize);
+    jassert(slot < stateSlotsInUse.size());
+    stateSlotsInUse[slot].store(false);
+}
+
+void ImpulseResponseBaker::run()
+{
+    while (!threadShouldExit())
+    {
+        const auto seenWakeUps = wakeUps.load(std::memory_order_acquire);
+        bool worked = false;
+        for (auto& job : jobs)
+        {
+            int expected = jobQueued;
+            if (job.status.compare_exchange_strong(expected, jobBaking, std::memory_order_acquire))
+            {
+                bake(job);
+                job.resonators.clear();
+                job.status.store(jobFree, std::memory_order_release);
+                worked = true;
+            }
+        }
+
+        if (!worked)
+        {
+            wakeUps.wait(seenWakeUps, std::memory_order_acquire);
+        }
+    }
+}
+
+void ImpulseResponseBaker::bake(Job& job)
+{
+    if (findSlot(job.key) >= 0) return; //baked in the meantime, for another voice
+
+    const int numResonators = job.resonators.size();
+    std::vector<std::vector<float>> storage(static_cast<size_t>(numResonators));
+    std::vector<float> impulseResponses[2] = {std::vector<float>(static_cast<size_t>(maxLength), 0.0f),
+                                              std::vector<float>(static_cast<size_t>(maxLength), 0.0f)};
+    std::vector<float> rendered(static_cast<size_t>(maxLength));
+    bool bakeable = numResonators > 0;
+
+    for (int k = 0; k + 1 < numResonators && bakeable; k += 2)
+    {
+        auto& left = *job.resonators[k];
+        auto& right = *job.resonators[k + 1];
+        //a passthrough resonator outputs its input immediately, which cannot be convolved without latency
+        if (left.passthrough || right.passthrough)
+        {
+            bakeable = false;
+            break;
+        }
+
+        renderImpulseResponse(left, rendered.data(), maxLength, storage[static_cast<size_t>(k)]);
+        juce::FloatVectorOperations::add(impulseResponses[0].data(), rendered.data(), maxLength);
+        if (!right.hasSameParametersAs(left))
+        {
+            renderImpulseResponse(right, rendered.data(), maxLength, storage[static_cast<size_t>(k + 1)]);
+        }
+        juce::FloatVectorOperations::add(impulseResponses[1].data(), rendered.data(), maxLength);
+    }
+
+    float peak = 0.0f;
+    int firstNonZero = maxLength;
+    for (const auto& impulseResponse : impulseResponses)
+    {
+        for (int i = 0; i < maxLength; i++)
+        {
+            const float magnitude = std::abs(impulseResponse[static_cast<size_t>(i)]);
+            peak = juce::jmax(peak, magnitude);
+            if (magnitude != 0.0f) firstNonZero = juce::jmin(firstNonZero, i);
+        }
+    }
+
+    int length = 0;
+    for (const auto& impulseResponse : impulseResponses)
+    {
+        for (int i = maxLength - 1; i >= length; i--)
+        {
+            if (std::abs(impulseResponse[static_cast<size_t>(i)]) > peak * audibleThreshold)
+            {
+                length = i + 1;
+                break;
+            }
+        }
+    }
+
+    //responses that are still ringing near the end of the render would be cut off audibly
+    bakeable = bakeable && peak > 0.0f && firstNonZero >= PartitionedConvolver::minFirstBlockSize
+        && length <= maxLength - maxLength / 8;
+
+    std::unique_ptr<Response> response;
+    if (bakeable)
+    {
+        int firstBlockSize = PartitionedConvolver::minFirstBlockSize;
+        while (firstBlockSize * 2 <= juce::jmin(firstNonZero, PartitionedConvolver::maxFirstBlockSize))
+        {
+            firstBlockSize *= 2;
+        }
+
+        response = std::make_unique<Response>();
+        response->length = length;
+        for (int c = 0; c < 2; c++)
+        {
+            response->channels[c] = std::make_unique<PartitionedConvolver::ImpulseResponse>(
+                impulseResponses[c].data(), length, firstBlockSize);
+            jassert(response->channels[c]->getStateSize() <= channelStateSize);
+        }
+
+        std::vector<float> noise(static_cast<size_t>(timingLength));
+        juce::Random random;
+        for (auto& sample : noise)
+        {
+            sample = random.nextFloat() * 2.0f - 1.0f;
+        }
+
+        const double liveSeconds = timeResonators(job, noise);
+        const double convolutionSeconds = timeConvolution(*response, noise);
+        if (convolutionSeconds * requiredSpeedup > liveSeconds)
+        {
+            response.reset();
+        }
+    }
+
+    insert(job.key, std::move(response));
+}
+
+void ImpulseResponseBaker::renderImpulseResponse(StereoResonator::Resonator& resonator, float* out, int length,
+                                                 std::vector<float>& storage)
+{
+    //the copy shares the voice's delay line storage, so it is given its own
+    storage.assign(resonator.delayLine.getRequiredStorageSize(), 0.0f);
+    resonator.delayLine.setStorage(storage.data());
+    resonator.loopFilter.reset();
+    resonator.apf.reset();
+    resonator.postFilter.reset();
+    resonator.delayLengthInterpolator.snapValue(resonator.delayLengthInSamples);
+    resonator.delayLengthInterpolator.setTargetValue(resonator.delayLengthInSamples, 1);
+
+    for (int i = 0; i < length; i++)
+    {
+        out[i] = resonator.postProcess(resonator.processSample(i == 0 ? 1.0f : 0.0f)) * resonator.gain;
+    }
+}
+
+/**
+ * As in WaveguideResonatorBank::processParallel(): the loops a block at a time, then the post filters.
+ * A right channel with the same parameters as its left is not counted, since the bank collapses it
+ * whenever its input is mono.
+ */
+double ImpulseResponseBaker::timeResonators(Job& job, const std::vector<float>& noise)
+{
+    std::vector<float> out(static_cast<size_t>(timingBlockSize));
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 2; run++)
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (int k = 0; k < job.resonators.size(); k++)
+        {
+            auto& resonator = *job.resonators[k];
+            if (k % 2 == 1 && resonator.hasSameParametersAs(*job.resonators[k - 1])) continue;
+            for (int i = 0; i + timingBlockSize <= timingLength; i += timingBlockSize)
+            {
+                resonator.keepParameters(timingBlockSize);
+                resonator.processBlock(noise.data() + i, out.data(), timingBlockSize);
+                for (auto& sample : out)
+                {
+                    sample = resonator.postProcess(sample) * resonator.gain;
+                }
+            }
+        }
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+        best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(elapsed));
+    }
+    return best;
+}
+
+double ImpulseResponseBaker::timeConvolution(const Response& response, const std::vector<float>& noise)
+{
+    std::vector<float> out(static_cast<size_t>(timingBlockSize));
+    std::vector<float> memory[2] = {std::vector<float>(response.channels[0]->getStateSize()),
+                                    std::vector<float>(response.channels[1]->getStateSize())};
+    PartitionedConvolver convolvers[2];
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 2; run++)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            convolvers[c].reset(*response.channels[c], memory[c].data());
+        }
+        const auto start = juce::Time::getHighResolutionTicks();
+        for (auto& convolver : convolvers)
+        {
+            for (int i = 0; i + timingBlockSize <= timingLength; i += timingBlockSize)
+            {
+                convolver.process(noise.data() + i, out.data(), timingBlockSize);
+            }
+        }
+        const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+        best = juce::jmin(best, juce::Time::highResolutionTicksToSeconds(elapsed));
+    }
+    return best;
+}
+
+/**
+ * Stores a response, or a rejection if response is null, in an empty slot or else in the least recently used one
+ * that no bank is using.
+ */
+void ImpulseResponseBaker::insert(Key key, std::unique_ptr<Response> response)
+{
+    while (true)
+    {
+        int victim = -1;
+        for (int i = 0; i < numCacheSlots; i++)
+        {
+            const auto& slot = cache[static_cast<size_t>(i)];
+            const int status = slot.status.load();
+            if (status == slotEmpty)
+            {
+                victim = i;
+                break;
+            }
+            if (slot.users.load() == 0
+                && (victim < 0 || slot.lastUsed.load() < cache[static_cast<size_t>(victim)].lastUsed.load()))
+            {
+                victim = i;
+            }
+        }
+        if (victim < 0) return; //every slot is in use; the bank will ask again on a later note
+
+        auto& slot = cache[static_cast<size_t>(victim)];
+        int status = slot.status.load();
+        if (status == slotEvicting || !slot.status.compare_exchange_strong(status, slotEvicting)) continue;
+        if (slot.users.load() != 0)
+        {
+            slot.status.store(status); //acquired in the meantime
+            continue;
+        }
+
+        slot.response = std::move(response);
+        slot.key.store(key);
+        slot.lastUsed.store(useClock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        slot.status.store(slot.response != nullptr ? slotReady : slotRejected);
+        return;
+    }
+}
+
+int ImpulseResponseBaker::findSlot(Key key) const noexcept
+{
+    for (int i = 0; i < numCacheSlots; i++)
+    {
+        const auto& slot = cache[static_cast<size_t>(i)];
+        const int status = slot.status.load();
+        if (slot.key.load() == key && (status == slotReady || status == slotRejected)) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,157 @@
+#ifndef IMPULSERESPONSEBAKER_H
+#define IMPULSERESPONSEBAKER_H
+
+#include "defines.h"
+#include "StereoResonator.h"
+#include "dsp/PartitionedConvolver.h"
+#include "util/InlineArray.h"
+
+class WaveguideResonatorBank;
+
+/**
+ * Bakes static resonator banks into impulse responses, on a background thread, and keeps them in a cache.
+ *
+ * A PARALLEL bank whose resonators are neither modulated nor keytracked, so that bending the note leaves it alone,
+ * is a linear time-invariant system from its input to the sum of its resonators. While it stays that way,
+ * its output is just its input convolved with the bank's impulse response, which is what a baked bank computes
+ * (see WaveguideResonatorBank).
+ *
+ * A bank asks for its impulse response at the start of a note. If it is not in the cache yet, the bank plays live,
+ * and the resonators are copied into a job for the baker thread. The thread renders their impulse response
+ * with their own DSP code, then times the live loops against the convolution:
+ * responses that would not be cheaper, that do not decay within maxLengthInSeconds, or that do not start with
+ * enough silence for zero-latency convolution, are cached as rejected, so the bank is not asked for again.
+ * Notes at the same pitch with the same settings then find their response in the cache.
+ *
+ * The audio thread only ever touches atomics and preallocated memory here: the cache, the job slots and
+ * the convolution state slots are all fixed-size, and the baker thread does all of the allocating.
+ */
+class ImpulseResponseBaker : private juce::Thread
+{
+public:
+    using Key = juce::uint64;
+
+    /**
+     * The impulse response of each channel of a bank, from the bank's input (after the input mix and gain)
+     * to the sum of its resonators' outputs, each post-filtered and multiplied by its gain.
+     * The bank's output gain and normalisation are applied afterwards, as for the live resonators.
+     */
+    struct Response
+    {
+        std::unique_ptr<PartitionedConvolver::ImpulseResponse> channels[2];
+        int length = 0;
+    };
+
+    /**
+     * A response in use by a bank; it stays in the cache until released.
+     */
+    struct Lease
+    {
+        const Response* response = nullptr;
+        int slot = -1;
+    };
+
+    static constexpr int numCacheSlots = 64;
+    static constexpr int numJobSlots = 4;
+    static constexpr int numStateSlots = 8; //how many banks, across all voices, can be baked at once
+    //long enough for pads and drones; each state slot holds about twice this many samples per channel
+    static constexpr double maxLengthInSeconds = 4.0;
+
+    ImpulseResponseBaker();
+    ~ImpulseResponseBaker() override;
+
+    /**
+     * Empties the cache and sizes everything for the sample rate. Call off the audio thread, with no leases out.
+     */
+    void prepare(double newSampleRate);
+
+    /**
+     * Identifies the response of a bank from the coefficients of its enabled resonators,
+     * which must have been updated for the current note.
+     */
+    static Key getKey(const WaveguideResonatorBank& bank) noexcept;
+
+    /**
+     * Looks up a response. Returns an empty lease if it is not ready; rejected is set if it has been baked,
+     * but found not to be worth convolving.
+     */
+    Lease acquire(Key key, bool& rejected) noexcept;
+    void release(Lease& lease) noexcept;
+
+    /**
+     * Queues the bank's resonators to be baked, unless they already are or every job slot is taken.
+     */
+    void requestBake(Key key, const WaveguideResonatorBank& bank) noexcept;
+
+    /**
+     * Returns the memory for the convolution state of both channels of a bank, i.e. two blocks of
+     * getChannelStateSize() floats, or nullptr if every slot is in use.
+     */
+    float* acquireState() noexcept;
+    void releaseState(float* memory) noexcept;
+    size_t getChannelStateSize() const noexcept { return channelStateSize; }
+
+private:
+    enum SlotStatus
+    {
+        slotEmpty,
+        slotReady,
+        slotRejected,
+        slotEvicting,
+    };
+
+    struct CacheSlot
+    {
+        std::atomic<Key> key { 0 };
+        std::atomic<int> status { slotEmpty };
+        std::atomic<int> users { 0 };
+        std::atomic<juce::uint32> lastUsed { 0 };
+        std::unique_ptr<Response> response;
+    };
+
+    enum JobStatus
+    {
+        jobFree,
+        jobFilling, //being written by the audio thread
+        jobQueued,
+        jobBaking, //being read by the baker thread
+    };
+
+    struct Job
+    {
+        std::atomic<int> status { jobFree };
+        Key key = 0;
+        //copies of the left and right channel of every enabled resonator, in turn
+        InlineArray<StereoResonator::Resonator, 2 * NUM_RESONATORS> resonators;
+    };
+
+    void run() override;
+    void stop();
+    void bake(Job& job);
+    /**
+     * Renders the impulse response of a resonator channel, including its post filter and gain, into out.
+     */
+    static void renderImpulseResponse(StereoResonator::Resonator& resonator, float* out, int length,
+                                      std::vector<float>& storage);
+    /**
+     * Seconds it takes to run the live resonators, and the convolution of both channels, over the same input.
+     */
+    static double timeResonators(Job& job, const std::vector<float>& noise);
+    static double timeConvolution(const Response& response, const std::vector<float>& noise);
+    void insert(Key key, std::unique_ptr<Response> response);
+    int findSlot(Key key) const noexcept;
+
+    std::array<CacheSlot, numCacheSlots> cache;
+    std::array<Job, numJobSlots> jobs;
+    std::array<std::atomic<bool>, numStateSlots> stateSlotsInUse {};
+    juce::HeapBlock<float> stateMemory;
+    size_t channelStateSize = 0;
+    double sampleRate = 0.0;
+    int maxLength = 0;
+    std::atomic<juce::uint32> useClock { 0 };
+    std::atomic<juce::uint32> wakeUps { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImpulseResponseBaker)
+};
+
+#endif //IMPULSERESPONSEBAKER_H
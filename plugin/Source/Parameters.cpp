@@ -77,6 +77,11 @@ static juce::String enableTextFunction(const gin::Parameter&, float v)
     return v > 0.0f ? "On" : "Off";
 }
 
+static juce::String controlPeriodTextFunction(const gin::Parameter&, float v)
+{
+    return juce::String(1 << static_cast<int>(v)) + " smp";
+}
+
 static juce::String durationTextFunction(const gin::Parameter&, float v)
 {
     return gin::NoteDuration::getNoteDurations()[size_t(v)].getName();
@@ -1005,6 +1010,26 @@ GlobalParams::GlobalParams(ResonariumProcessor& p)
     polyEffectChain = p.addIntParam("polyEffectChain", "Poly Effect Chain", "Poly FX", "",
                                     {0.0f, 1.0f, 1.0f, 1.0f}, 0.0f,
                                     0.0f, "global.polyfx", enableTextFunction);
+
+    multithreadedVoices = p.addIntParam("multithreadedVoices", "Multithreaded Rendering", "Threads", "",
+                                        {0.0f, 1.0f, 1.0f, 1.0f}, 0.0f,
+                                        0.0f, "global.multithread", enableTextFunction);
+
+    controlPeriod = p.addIntParam("controlPeriod", "Control Period", "Ctrl Rate", "",
+                                  {4.0f, 7.0f, 1.0f, 1.0f}, 6.0f,
+                                  0.0f, "global.controlperiod", controlPeriodTextFunction);
+
+    bakeResonators = p.addIntParam("bakeResonators", "Bake Static Resonators", "Bake", "",
+                                   {0.0f, 1.0f, 1.0f, 1.0f}, 0.0f,
+                                   0.0f, "global.bake", enableTextFunction);
+
+    voiceGovernor = p.addIntParam("voiceGovernor", "Polyphony Governor", "Governor", "",
+                                  {0.0f, 1.0f, 1.0f, 1.0f}, 1.0f,
+                                  0.0f, "global.governor", enableTextFunction);
+
+    cpuLimit = p.addIntParam("cpuLimit", "CPU Limit", "CPU Limit", "%",
+                             {25.0f, 100.0f, 1.0f, 1.0f}, 80.0f,
+                             0.0f, "global.cpulimit");
 }
 
 UIParams::UIParams(ResonariumProcessor& p)
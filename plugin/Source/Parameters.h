@@ -448,6 +448,11 @@ struct GlobalParams
     gin::Parameter::Ptr numVoices,
                         stereoResonators,
                         polyEffectChain,
+                        multithreadedVoices,
+                        controlPeriod, //log2 of the control period in samples, see ResonatorSynth::renderNextSubBlock()
+                        bakeResonators,
+                        voiceGovernor, //cap polyphony when rendering takes too much of the real-time budget
+                        cpuLimit, //the governor's threshold, in percent of the real-time budget
                         gain;
 
     GlobalParams() = default;
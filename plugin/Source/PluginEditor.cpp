@@ -234,7 +234,7 @@ ResonariumEditor::ResonariumEditor(ResonariumProcessor& p)
     effectsViewportContentComponent->addAndMakeVisible(filter2ParamBox);
 
     globalParamBox = new GlobalParamBox("Global", proc, proc.synth.params.globalParams);
-    globalParamBox->setBounds(effectsColumnLocal.removeFromTop(PARAM_BOX_XSMALL_HEIGHT));
+    globalParamBox->setBounds(effectsColumnLocal.removeFromTop(PARAM_BOX_MEDIUM_HEIGHT));
     effectsViewportContentComponent->addAndMakeVisible(globalParamBox);
 
     //compute a rectangle that is the size of all the components in the viewport
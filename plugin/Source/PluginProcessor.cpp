@@ -1,6 +1,7 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "ResonatorVoice.h"
+#include "ImpulseResponseBaker.h"
 #include "ui/ResonariumLookAndFeel.h"
 #include "BinaryData.h"
 #include "util/ResonariumUtilities.h"
@@ -22,9 +23,10 @@ gin::ProcessorOptions ResonariumProcessor::getOptions()
 }
 
 //==============================================================================
-ResonariumProcessor::ResonariumProcessor() :
+ResonariumProcessor::ResonariumProcessor(bool headless) :
     gin::Processor(false, getOptions(),
                    juce::JSON::parse(juce::String(BinaryData::tooltips_json, BinaryData::tooltips_jsonSize))),
+    headless(headless),
     synth(globalState, SynthParams(*this)),
     uiParams(*this)
 {
@@ -33,7 +35,11 @@ ResonariumProcessor::ResonariumProcessor() :
     MelatoninPerfetto::get().beginSession();
 #endif
 
-    lf = std::make_unique<ResonariumLookAndFeel>();
+    if (!headless)
+    {
+        lf = std::make_unique<ResonariumLookAndFeel>();
+        resonatorMemoryTimer.startTimerHz(20);
+    }
 
     auto sz = 0;
     for (auto i = 0; i < BinaryData::namedResourceListSize; i++)
@@ -144,19 +150,23 @@ void ResonariumProcessor::setupModMatrix()
                                                                              name, false);
     }
 
+    //the macros are only ever read by the synth, so they are mono; every other parameter can be read by a voice
+    const auto& macros = synth.params.macroParams;
     for (auto pp : getPluginParameters())
     {
-        //TODO Add a way to choose whether parameters are mono or poly, right now everything is poly
         if (!pp->isInternal())
         {
+            const bool poly = std::find(macros.begin(), macros.end(), pp) == macros.end();
             DBG("  Adding parameter " + pp->getName(40) + " with id " + pp->getParameterID() +
-                " to mod matrix as a poly parameter");
-            globalState.modMatrix.addParameter(pp, true, 0.02);
+                " to mod matrix as a " + (poly ? "poly" : "mono") + " parameter");
+            globalState.modMatrix.addParameter(pp, poly, PARAMETER_SMOOTHING_TIME);
+            globalState.modRouting.setPolyphony(pp, poly ? ModRouting::Polyphony::poly : ModRouting::Polyphony::mono);
         }
     }
     DBG("TOTAL PARAMETERS REGISTERED: " + juce::String(getPluginParameters().size()));
 
     globalState.modMatrix.build();
+    globalState.modRouting.attach(globalState.modMatrix);
 }
 
 //==============================================================================
@@ -164,6 +174,7 @@ void ResonariumProcessor::stateUpdated()
 {
     DBG("Updating state FROM disk");
     globalState.modMatrix.stateUpdated(state);
+    globalState.modRouting.refresh();
 
     for (int i = 0; i < NUM_MSEGS; i++)
     {
@@ -216,12 +227,36 @@ void ResonariumProcessor::stateUpdated()
         resonariumEditor->sampleExciterParamBox->sampleDropper->updateFromSampler();
     }
 
+    //the preset may enable resonators that have no delay line storage yet
+    synth.allocateResonatorMemory();
+
     globalState.logPrefix = "[" + getProgramName(getCurrentProgram()) + "] ";
     DBG(globalState.logPrefix + " State updated from disk successfully!");
 
     if (prepared) reset();
 }
 
+bool ResonariumProcessor::loadPresetFile(const juce::File& file)
+{
+    if (!file.existsAsFile())
+    {
+        DBG("Preset file does not exist: " + file.getFullPathName());
+        return false;
+    }
+
+    gin::Program program;
+    program.loadFromFile(file, true);
+    if (!program.fullyLoaded)
+    {
+        DBG("Could not parse preset file: " + file.getFullPathName());
+        return false;
+    }
+
+    program.loadProcessor(*this);
+    stateUpdated();
+    return true;
+}
+
 void ResonariumProcessor::updateState()
 {
     DBG("Updating plugin state TO disk");
@@ -248,7 +283,17 @@ void ResonariumProcessor::prepareToPlay(double newSampleRate, int newSamplesPerB
     prepared = true;
     Processor::prepareToPlay(newSampleRate, newSamplesPerBlock);
     globalState.modMatrix.setSampleRate(newSampleRate);
+    if (!headless && synth.params.globalParams.multithreadedVoices->isOn()) createThreadPool();
     synth.prepare({newSampleRate, static_cast<juce::uint32>(newSamplesPerBlock), 2});
+    //offline renders always play the resonators live, so that they do not depend on the baker thread's timing
+    if (!headless)
+    {
+        if (globalState.impulseResponseBaker == nullptr)
+        {
+            globalState.impulseResponseBaker = std::make_unique<ImpulseResponseBaker>();
+        }
+        globalState.impulseResponseBaker->prepare(newSampleRate);
+    }
     globalState.extInputBuffer = juce::AudioBuffer<float>(2, newSamplesPerBlock);
     globalState.extInputBuffer.clear();
     reset();
@@ -259,6 +304,28 @@ void ResonariumProcessor::prepareToPlay(double newSampleRate, int newSamplesPerB
     DBG("   Samples per block: " + juce::String(newSamplesPerBlock));
 }
 
+void ResonariumProcessor::audioWorkgroupContextChanged(const juce::AudioWorkgroup& workgroup)
+{
+    const juce::ScopedLock lock(threadPoolLock);
+    audioWorkgroup = workgroup;
+    if (auto* threadPool = globalState.threadPool.load(std::memory_order_acquire)) threadPool->setWorkgroup(workgroup);
+}
+
+void ResonariumProcessor::createThreadPool()
+{
+    const juce::ScopedLock lock(threadPoolLock);
+    if (globalState.threadPool.load(std::memory_order_acquire) != nullptr) return;
+
+    //the workers share the audio thread's deadline, so they are scheduled for the same period
+    auto options = juce::Thread::RealtimeOptions {};
+    if (getSampleRate() > 0.0 && getBlockSize() > 0)
+        options = options.withApproximateAudioProcessingTime(getBlockSize(), getSampleRate());
+    globalState.threadPoolStorage = std::make_unique<RealtimeThreadPool>(RealtimeThreadPool::getDefaultNumWorkers(),
+                                                                         options);
+    globalState.threadPoolStorage->setWorkgroup(audioWorkgroup);
+    globalState.threadPool.store(globalState.threadPoolStorage.get(), std::memory_order_release);
+}
+
 void ResonariumProcessor::releaseResources()
 {
     DBG("Releasing resources...");
@@ -266,6 +333,8 @@ void ResonariumProcessor::releaseResources()
 
 void ResonariumProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
 {
+    TRACE_DSP();
+    const auto blockStart = juce::Time::getHighResolutionTicks();
     juce::ScopedNoDenormals noDenormals;
 
     //toggle the constant note on or off based on the note parameters
@@ -332,10 +401,14 @@ void ResonariumProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
     globalState.playHead = getPlayHead();
 
     //process audio
+    const auto renderStart = juce::Time::getHighResolutionTicks();
     synth.startBlock();
     synth.renderNextBlock(buffer, midi, 0, buffer.getNumSamples());
     globalState.modMatrix.finishBlock(buffer.getNumSamples());
     synth.endBlock(buffer.getNumSamples());
+    //offline renders have no real-time budget, and must not depend on how fast they happen to run
+    const double renderSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - renderStart);
+    synth.updatePolyphony(renderSeconds, buffer.getNumSamples(), !headless && !isNonRealtime());
     midi.clear();
     globalState.extInputBuffer.clear();
 
@@ -385,16 +458,57 @@ void ResonariumProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::M
 
     if (buffer.getNumSamples() <= scopeFifo.getFreeSpace() && buffer.getNumChannels() == scopeFifo.getNumChannels())
         scopeFifo.write(buffer);
+
+    //the block is folded into the statistics before returning, so that offline and Python readers see it too
+    const auto blockTicks = juce::Time::getHighResolutionTicks() - blockStart;
+    globalState.profiler.add(StageProfiler::processBlock, blockTicks);
+    globalState.profiler.finishBlock();
+
+    //offline renders have no real-time budget to overrun, so only real-time blocks are recorded
+    if (!headless && !isNonRealtime())
+    {
+        const double blockSeconds = juce::Time::highResolutionTicksToSeconds(blockTicks);
+        const double budgetSeconds = buffer.getNumSamples() / getSampleRate();
+        if (blockTimeRecorder.addBlock(blockSeconds, budgetSeconds))
+        {
+            BlockTimeRecorder::Overrun overrun;
+            overrun.time = juce::Time::currentTimeMillis();
+            overrun.renderMicroseconds = static_cast<float>(blockSeconds * 1.0e6);
+            overrun.budgetMicroseconds = static_cast<float>(budgetSeconds * 1.0e6);
+            overrun.numActiveVoices = synth.getNumActiveVoices();
+            overrun.enabledBanks = getEnabledResonatorBanks();
+            overrun.program = getCurrentProgram();
+            blockTimeRecorder.addOverrun(overrun);
+        }
+    }
+}
+
+int ResonariumProcessor::getEnabledResonatorBanks() const
+{
+    int banks = 0;
+    for (int b = 0; b < NUM_RESONATOR_BANKS; b++)
+    {
+        for (const auto& resonatorParams : synth.params.voiceParams.waveguideResonatorBankParams[b].resonatorParams)
+        {
+            if (resonatorParams.enabled->isOn())
+            {
+                banks |= 1 << b;
+                break;
+            }
+        }
+    }
+    return banks;
 }
 
 //==============================================================================
 bool ResonariumProcessor::hasEditor() const
 {
-    return true;
+    return !headless;
 }
 
 juce::AudioProcessorEditor* ResonariumProcessor::createEditor()
 {
+    jassert(!headless);
     DBG("Instantiating new ResonariumEditor instance!");
     auto* editor = new gin::ScaledPluginEditor(new ResonariumEditor(*this), state);
     editor->editor->resized();
@@ -4,6 +4,7 @@
 #include "Parameters.h"
 #include <melatonin_perfetto/melatonin_perfetto.h>
 #include "GlobalState.h"
+#include "util/BlockTimeRecorder.h"
 #include <gin/gin.h>
 #include <gin_plugin/gin_plugin.h>
 
@@ -11,7 +12,11 @@
 class ResonariumProcessor : public gin::Processor
 {
 public:
-    ResonariumProcessor();
+    /**
+     * @param headless if true, the processor is set up for offline rendering only:
+     * no LookAndFeel is created, no editor can be opened, and no worker threads are spawned for multithreaded rendering.
+     */
+    explicit ResonariumProcessor(bool headless = false);
     ~ResonariumProcessor() override;
 
     void stateUpdated() override;
@@ -20,20 +25,41 @@ public:
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void audioWorkgroupContextChanged(const juce::AudioWorkgroup& workgroup) override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
     bool supportsMPE() const override { return true; }
     void setupModMatrix();
     static gin::ProcessorOptions getOptions();
+
+    /**
+     * Loads a preset from an XML file, as written by the preset browser, without adding it to the program list.
+     * Returns false if the file could not be read.
+     */
+    bool loadPresetFile(const juce::File& file);
     
     // Get the synthesizer instance (needed for Python bindings)
     ResonatorSynth* getSynth() { return &synth; }
 
+    /**
+     * Returns a bit mask of the resonator banks with at least one resonator enabled: bit b for bank b.
+     */
+    int getEnabledResonatorBanks() const;
+
+    /**
+     * Spawns the worker threads for multithreaded rendering, unless they already have been; they are then kept
+     * for the life of the processor. Call off the audio thread, which picks the pool up from the next block.
+     * Nothing is spawned until multithreaded rendering is switched on, or the Python batch renderer asks for it.
+     */
+    void createThreadPool();
+
+    const bool headless;
     ResonatorSynth synth;
     UIParams uiParams;
     GlobalState globalState;
     gin::AudioFifo scopeFifo { 2, 44100 };
+    BlockTimeRecorder blockTimeRecorder; //how long each real-time block took to render, and which ones overran
     int pluginInstanceID = -1;
     bool prepared = false; //indicates that prepareToPlay has been called at least once
     bool soloActive = false; //true if a resonator is in solo mode
@@ -45,6 +71,29 @@ public:
     const int constantNoteChannel = 15;
     float constantNoteFrequency = 440.0f;
 
+    /**
+     * Does, on the message thread, what the audio thread must not: allocates delay line storage for resonators
+     * enabled by the user or the host since the last preset load, and spawns the thread pool once multithreaded
+     * rendering is switched on. Offline renderers call ResonatorSynth::allocateResonatorMemory() themselves instead.
+     */
+    class ResonatorMemoryTimer : public juce::Timer
+    {
+    public:
+        explicit ResonatorMemoryTimer(ResonariumProcessor& processor) : processor(processor) {}
+
+        void timerCallback() override
+        {
+            processor.synth.allocateResonatorMemory();
+            if (processor.synth.params.globalParams.multithreadedVoices->isOn()) processor.createThreadPool();
+        }
+
+    private:
+        ResonariumProcessor& processor;
+    };
+    juce::CriticalSection threadPoolLock; //guards the creation of the thread pool, and audioWorkgroup
+    juce::AudioWorkgroup audioWorkgroup; //the host's workgroup for the audio thread, which the workers join
+    ResonatorMemoryTimer resonatorMemoryTimer { *this };
+
 #if PERFETTO
     std::unique_ptr<perfetto::TracingSession> tracingSession;
 #endif
@@ -0,0 +1,67 @@
+#include "PolyphonyGovernor.h"
+
+void PolyphonyGovernor::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+}
+
+void PolyphonyGovernor::reset(int maxVoices)
+{
+    load.store(0.0f, std::memory_order_relaxed);
+    voiceLimit.store(maxVoices, std::memory_order_relaxed);
+    samplesSinceCut = 0;
+    samplesOfHeadroom = 0;
+}
+
+int PolyphonyGovernor::update(double renderSeconds, int numSamples, int numActiveVoices, int maxVoices,
+                              float loadThreshold)
+{
+    if (numSamples <= 0) return voiceLimit.load(std::memory_order_relaxed);
+
+    const auto blockLoad = static_cast<float>(renderSeconds * sampleRate / numSamples);
+    float smoothedLoad = load.load(std::memory_order_relaxed);
+    if (blockLoad > smoothedLoad)
+    {
+        //a single slow block is often a one-off (a page fault, another plugin), so rises are only halved in
+        smoothedLoad += 0.5f * (blockLoad - smoothedLoad);
+    }
+    else
+    {
+        smoothedLoad += static_cast<float>(1.0 - std::exp(-numSamples / (loadReleaseTime * sampleRate)))
+            * (blockLoad - smoothedLoad);
+    }
+    load.store(smoothedLoad, std::memory_order_relaxed);
+
+    int limit = juce::jmin(voiceLimit.load(std::memory_order_relaxed), maxVoices);
+    //saturated at the hold time, which is all that is compared against, so that it never overflows
+    const auto holdSamples = static_cast<int>(std::ceil(holdTime * sampleRate));
+    samplesSinceCut = juce::jmin(samplesSinceCut + numSamples, holdSamples);
+    if (smoothedLoad > loadThreshold)
+    {
+        samplesOfHeadroom = 0;
+        if (samplesSinceCut >= holdSamples && numActiveVoices > 1)
+        {
+            //the cost is roughly proportional to the number of voices, so cut to as many as fit the threshold
+            const int fit = static_cast<int>(static_cast<float>(numActiveVoices) * loadThreshold / smoothedLoad);
+            limit = juce::jlimit(1, numActiveVoices - 1, fit);
+            samplesSinceCut = 0;
+        }
+    }
+    else if (smoothedLoad < loadThreshold * headroom)
+    {
+        samplesOfHeadroom += numSamples;
+        if (samplesOfHeadroom >= relaxTime * sampleRate)
+        {
+            limit++;
+            samplesOfHeadroom = 0;
+        }
+    }
+    else
+    {
+        samplesOfHeadroom = 0;
+    }
+
+    limit = juce::jlimit(1, maxVoices, limit);
+    voiceLimit.store(limit, std::memory_order_relaxed);
+    return limit;
+}
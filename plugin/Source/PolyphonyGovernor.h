@@ -0,0 +1,51 @@
+#ifndef POLYPHONYGOVERNOR_H
+#define POLYPHONYGOVERNOR_H
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Keeps the synth within its real-time budget by capping polyphony.
+ *
+ * After every block, the governor compares the time it took to render against the block's real-time budget,
+ * i.e. its length in seconds, and tracks the resulting load: quickly as it rises, slowly as it falls.
+ * While the load is above the threshold, the voice limit is cut in proportion to the overload,
+ * at most once per holdTime so that each cut can take effect before the next one; the synth then steals
+ * the least audible voices above the limit (see ResonatorSynth::updatePolyphony()).
+ * Once the load has stayed comfortably below the threshold for relaxTime, the limit goes back up one voice at a time.
+ *
+ * Only the audio thread touches the governor, except for getLoad() and getVoiceLimit(), which are safe to call from anywhere.
+ */
+class PolyphonyGovernor
+{
+public:
+    static constexpr double holdTime = 0.05; //seconds between two cuts
+    static constexpr double relaxTime = 0.5; //seconds of headroom before the limit is raised by one voice
+    static constexpr double loadReleaseTime = 0.2; //time constant of the load's decay, in seconds
+    static constexpr float headroom = 0.75f; //the load must fall below this fraction of the threshold to raise the limit
+
+    void prepare(double newSampleRate);
+
+    /**
+     * Lifts the limit back to maxVoices and forgets the measured load.
+     */
+    void reset(int maxVoices);
+
+    /**
+     * Records that rendering numSamples took renderSeconds while numActiveVoices were playing,
+     * and returns the new voice limit, between 1 and maxVoices.
+     * @param loadThreshold the highest acceptable fraction of the budget
+     */
+    int update(double renderSeconds, int numSamples, int numActiveVoices, int maxVoices, float loadThreshold);
+
+    float getLoad() const noexcept { return load.load(std::memory_order_relaxed); }
+    int getVoiceLimit() const noexcept { return voiceLimit.load(std::memory_order_relaxed); }
+
+private:
+    double sampleRate = 44100.0;
+    std::atomic<float> load { 0.0f }; //the smoothed fraction of the real-time budget spent rendering
+    std::atomic<int> voiceLimit { 1 };
+    int samplesSinceCut = 0; //up to holdTime's worth
+    int samplesOfHeadroom = 0;
+};
+
+#endif //POLYPHONYGOVERNOR_H
@@ -0,0 +1,386 @@
+#include <iostream>
+#include "PluginProcessor.h"
+#include "ResonatorVoice.h"
+
+/**
+ * Resonarium_Benchmarks: measures the CPU cost of the resonator engine in nanoseconds per output sample,
+ * and writes the results as JSON so that they can be compared before and after a DSP change.
+ *
+ * ResonatorVoice and WaveguideResonatorBank are driven directly. The processor is only instantiated to host
+ * the parameters and the modulation matrix that the voices read from; no plugin wrapper, host, or editor is involved.
+ *
+ * Usage: Resonarium_Benchmarks [--output <file.json>] [--seconds <seconds of audio per measurement>] [--full]
+ *
+ * Three sweeps are run for each coupling mode:
+ *   bank:  a single WaveguideResonatorBank with 1-8 resonators, at every sample rate
+ *   voice: 1-64 ResonatorVoices with 1-4 banks of 8 resonators each
+ *   block: a single voice with 4 banks of 8 resonators, for every block size and sample rate
+ * --full replaces the voice sweep with the full cross product of resonators, banks, voices, block sizes and sample rates.
+ */
+
+namespace
+{
+    const juce::StringArray couplingModeNames = {"PARALLEL", "INTERLINKED", "CASCADE"};
+    const std::vector<double> sampleRates = {44100.0, 48000.0, 96000.0};
+    const std::vector<int> blockSizes = {16, 32, 64, 128, 256, 512, 1024, 2048};
+    const std::vector<int> voiceCounts = {1, 2, 4, 8, 16, 32, 64};
+
+    struct BenchmarkConfig
+    {
+        juce::String suite;
+        WaveguideResonatorBank::CouplingMode couplingMode = WaveguideResonatorBank::PARALLEL;
+        int numResonators = NUM_RESONATORS;
+        int numBanks = 1;
+        int numVoices = 1;
+        int blockSize = 512;
+        double sampleRate = 48000.0;
+    };
+
+    struct BenchmarkResult
+    {
+        double nanosecondsPerSample = 0.0;
+        double realtimeLoad = 0.0; //fraction of the real-time budget used, i.e. processing time / audio duration
+        int activeVoices = 0; //voices still sounding at the end of the measurement; anything less than requested is suspect
+    };
+
+    class ResonatorBenchmark
+    {
+    public:
+        explicit ResonatorBenchmark(double secondsPerMeasurement) : secondsPerMeasurement(secondsPerMeasurement)
+        {
+        }
+
+        BenchmarkResult run(const BenchmarkConfig& config)
+        {
+            configure(config);
+            startVoices(config);
+            const auto result = config.suite == "bank" ? measureBank(config) : measureVoices(config);
+            stopVoices(config);
+            return result;
+        }
+
+    private:
+        void setParam(const juce::String& id, float value)
+        {
+            gin::Parameter* param = processor.getParameter(id);
+            jassert(param != nullptr);
+            if (param != nullptr) param->setUserValue(value);
+        }
+
+        /**
+         * Brings every parameter back to its default, then enables the requested resonators and banks.
+         * The resonators are tuned to a harmonic series, and a sustained noise exciter keeps them ringing,
+         * so that none of them fall asleep during the measurement.
+         */
+        void configure(const BenchmarkConfig& config)
+        {
+            processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+            for (auto* param : processor.getPluginParameters())
+            {
+                param->setUserValue(param->getUserDefaultValue());
+            }
+
+            setParam("noiseExciter0enabled", 1.0f);
+            setParam("noiseExciter0level", 0.1f);
+            setParam("noiseExciterEnv0sustain", 100.0f);
+
+            for (int b = 0; b < config.numBanks; b++)
+            {
+                const juce::String bankSuffix = " wb" + juce::String(b);
+                setParam("couplingMode" + bankSuffix, static_cast<float>(config.couplingMode));
+                for (int r = 0; r < config.numResonators; r++)
+                {
+                    const juce::String suffix = bankSuffix + "r" + juce::String(r);
+                    setParam("enabled" + suffix, 1.0f);
+                    setParam("pitch" + suffix, static_cast<float>(r + 1));
+                }
+            }
+            processor.getSynth()->allocateResonatorMemory();
+        }
+
+        ResonatorVoice* getVoice(int index)
+        {
+            return dynamic_cast<ResonatorVoice*>(processor.getSynth()->getVoice(index));
+        }
+
+        void startVoices(const BenchmarkConfig& config)
+        {
+            for (int v = 0; v < config.numVoices; v++)
+            {
+                auto* voice = getVoice(v);
+                const int noteNumber = 36 + (v * 5) % 48;
+                voice->setCurrentlyPlayingNote(juce::MPENote(
+                    1 + v % 15,
+                    noteNumber,
+                    juce::MPEValue::fromUnsignedFloat(0.8f), //velocity
+                    juce::MPEValue::centreValue(), //pitchbend
+                    juce::MPEValue::minValue(), //pressure
+                    juce::MPEValue::centreValue(), //timbre
+                    juce::MPENote::keyDown));
+                voice->noteStarted();
+            }
+        }
+
+        void stopVoices(const BenchmarkConfig& config)
+        {
+            for (int v = 0; v < config.numVoices; v++)
+            {
+                getVoice(v)->noteStopped(false);
+            }
+        }
+
+        int getNumBlocks(const BenchmarkConfig& config) const
+        {
+            return juce::jmax(1, juce::roundToInt(secondsPerMeasurement * config.sampleRate / config.blockSize));
+        }
+
+        BenchmarkResult makeResult(const BenchmarkConfig& config, juce::int64 elapsedTicks, int numBlocks, int activeVoices) const
+        {
+            const double elapsedSeconds = juce::Time::highResolutionTicksToSeconds(elapsedTicks);
+            const double numSamples = static_cast<double>(numBlocks) * config.blockSize;
+
+            BenchmarkResult result;
+            result.nanosecondsPerSample = elapsedSeconds * 1.0e9 / numSamples;
+            result.realtimeLoad = elapsedSeconds / (numSamples / config.sampleRate);
+            result.activeVoices = activeVoices;
+            return result;
+        }
+
+        /**
+         * Renders whole voices, exciters and effect chain included, summing them into a single output buffer.
+         */
+        BenchmarkResult measureVoices(const BenchmarkConfig& config)
+        {
+            juce::AudioBuffer<float> buffer(2, config.blockSize);
+            auto renderBlock = [&]
+            {
+                buffer.clear();
+                for (int v = 0; v < config.numVoices; v++)
+                {
+                    auto* voice = getVoice(v);
+                    if (voice->isVoiceActive()) voice->renderNextBlock(buffer, 0, config.blockSize);
+                }
+                processor.globalState.modMatrix.finishBlock(config.blockSize);
+            };
+
+            const int numBlocks = getNumBlocks(config);
+            for (int i = 0; i < numBlocks / 10 + 1; i++)
+            {
+                renderBlock();
+            }
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int i = 0; i < numBlocks; i++)
+            {
+                renderBlock();
+            }
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            int activeVoices = 0;
+            for (int v = 0; v < config.numVoices; v++)
+            {
+                if (getVoice(v)->isVoiceActive()) activeVoices++;
+            }
+            return makeResult(config, elapsed, numBlocks, activeVoices);
+        }
+
+        /**
+         * Runs the first bank of a single voice in isolation, fed with pre-generated noise.
+         */
+        BenchmarkResult measureBank(const BenchmarkConfig& config)
+        {
+            auto* voice = getVoice(0);
+            auto* bank = voice->resonatorBanks[0];
+            const int numBlocks = getNumBlocks(config);
+
+            juce::Random random(1234);
+            juce::AudioBuffer<float> inputBuffer(2, config.blockSize * numBlocks);
+            for (int c = 0; c < 2; c++)
+            {
+                auto* input = inputBuffer.getWritePointer(c);
+                for (int i = 0; i < inputBuffer.getNumSamples(); i++)
+                {
+                    input[i] = 0.1f * (2.0f * random.nextFloat() - 1.0f);
+                }
+            }
+            juce::AudioBuffer<float> outputBuffer(2, config.blockSize);
+
+            voice->currentBlockStartSample = 0;
+            voice->currentBlockNumSamples = config.blockSize;
+            auto processBlock = [&](int blockIndex)
+            {
+                auto inputBlock = juce::dsp::AudioBlock<float>(inputBuffer)
+                    .getSubBlock(static_cast<size_t>(blockIndex * config.blockSize), static_cast<size_t>(config.blockSize));
+                auto outputBlock = juce::dsp::AudioBlock<float>(outputBuffer);
+                outputBlock.clear();
+                bank->updateParameters(voice->frequency, config.blockSize);
+                bank->process(inputBlock, outputBlock);
+            };
+
+            for (int i = 0; i < numBlocks / 10 + 1; i++)
+            {
+                processBlock(i % numBlocks);
+            }
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int i = 0; i < numBlocks; i++)
+            {
+                processBlock(i);
+            }
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+
+            return makeResult(config, elapsed, numBlocks, bank->sleeping ? 0 : 1);
+        }
+
+        //headless, like Resonarium_Render: no LookAndFeel, timers or background threads compete with the timed loop
+        ResonariumProcessor processor { true };
+        double secondsPerMeasurement;
+    };
+
+    std::vector<BenchmarkConfig> getConfigs(bool full)
+    {
+        std::vector<BenchmarkConfig> configs;
+        for (int mode = WaveguideResonatorBank::PARALLEL; mode <= WaveguideResonatorBank::CASCADE; mode++)
+        {
+            BenchmarkConfig config;
+            config.couplingMode = static_cast<WaveguideResonatorBank::CouplingMode>(mode);
+
+            config.suite = "bank";
+            for (const double sampleRate : sampleRates)
+            {
+                for (int numResonators = 1; numResonators <= NUM_RESONATORS; numResonators++)
+                {
+                    config.sampleRate = sampleRate;
+                    config.numResonators = numResonators;
+                    configs.push_back(config);
+                }
+            }
+
+            config = BenchmarkConfig();
+            config.couplingMode = static_cast<WaveguideResonatorBank::CouplingMode>(mode);
+            config.suite = "block";
+            config.numBanks = NUM_RESONATOR_BANKS;
+            for (const double sampleRate : sampleRates)
+            {
+                for (const int blockSize : blockSizes)
+                {
+                    config.sampleRate = sampleRate;
+                    config.blockSize = blockSize;
+                    configs.push_back(config);
+                }
+            }
+
+            config = BenchmarkConfig();
+            config.couplingMode = static_cast<WaveguideResonatorBank::CouplingMode>(mode);
+            config.suite = "voice";
+            for (int numBanks = 1; numBanks <= NUM_RESONATOR_BANKS; numBanks++)
+            {
+                for (const int numVoices : voiceCounts)
+                {
+                    config.numBanks = numBanks;
+                    config.numVoices = numVoices;
+                    if (!full)
+                    {
+                        configs.push_back(config);
+                        continue;
+                    }
+
+                    for (int numResonators = 1; numResonators <= NUM_RESONATORS; numResonators++)
+                    {
+                        for (const double sampleRate : sampleRates)
+                        {
+                            for (const int blockSize : blockSizes)
+                            {
+                                config.numResonators = numResonators;
+                                config.sampleRate = sampleRate;
+                                config.blockSize = blockSize;
+                                configs.push_back(config);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return configs;
+    }
+
+    juce::var toVar(const BenchmarkConfig& config, const BenchmarkResult& result)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("suite", config.suite);
+        object->setProperty("couplingMode", couplingModeNames[config.couplingMode]);
+        object->setProperty("numResonators", config.numResonators);
+        object->setProperty("numBanks", config.numBanks);
+        object->setProperty("numVoices", config.numVoices);
+        object->setProperty("blockSize", config.blockSize);
+        object->setProperty("sampleRate", config.sampleRate);
+        object->setProperty("nsPerSample", result.nanosecondsPerSample);
+        object->setProperty("realtimeLoad", result.realtimeLoad);
+        object->setProperty("activeVoices", result.activeVoices);
+        return juce::var(object);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::File outputFile = juce::File::getCurrentWorkingDirectory().getChildFile("resonarium_benchmarks.json");
+    double secondsPerMeasurement = 1.0;
+    bool full = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const juce::String arg(argv[i]);
+        if (arg == "--output" && i + 1 < argc)
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (arg == "--seconds" && i + 1 < argc)
+            secondsPerMeasurement = juce::jmax(0.01, juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--full")
+            full = true;
+        else
+        {
+            std::cerr << "Usage: Resonarium_Benchmarks [--output <file.json>] [--seconds <seconds>] [--full]" << std::endl;
+            return 1;
+        }
+    }
+
+    ResonatorBenchmark benchmark(secondsPerMeasurement);
+    const auto configs = getConfigs(full);
+
+    juce::Array<juce::var> results;
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        const auto& config = configs[i];
+        const auto result = benchmark.run(config);
+        results.add(toVar(config, result));
+
+        std::cout << "[" << (i + 1) << "/" << configs.size() << "] "
+            << config.suite << " " << couplingModeNames[config.couplingMode] << " "
+            << config.numResonators << " resonators, " << config.numBanks << " banks, " << config.numVoices << " voices, "
+            << config.blockSize << " samples @ " << config.sampleRate << " Hz: "
+            << result.nanosecondsPerSample << " ns/sample" << std::endl;
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+#if JUCE_DEBUG
+    root->setProperty("buildType", "Debug");
+#else
+    root->setProperty("buildType", "Release");
+#endif
+    root->setProperty("secondsPerMeasurement", secondsPerMeasurement);
+    root->setProperty("results", results);
+
+    if (!outputFile.replaceWithText(juce::JSON::toString(juce::var(root))))
+    {
+        std::cerr << "Could not write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    std::cout << "Results written to " << outputFile.getFullPathName() << std::endl;
+    return 0;
+}
@@ -40,19 +40,69 @@ struct PyModSourceInfo
     }
 };
 
+/**
+* One row of a batch render: a note, held for a duration, with optional parameter values that apply to this note only.
+*/
+struct PyBatchNote
+{
+    int note;
+    int velocity;
+    double duration; //in seconds, until the note is released
+    std::vector<std::pair<std::string, float>> overrides; //sorted by parameter ID
+};
+
+/**
+* A timestamped event for ResonariumWrapper::renderEvents: either a MIDI message, or a parameter change.
+*/
+struct PyTimedEvent
+{
+    int sample; //position in the render, in samples
+    juce::MidiMessage message;
+    gin::Parameter* param = nullptr; //if set, this is a parameter change rather than a MIDI message
+    float value = 0.0f;
+};
+
+/**
+* Returns pointers to the two channels of a (2, numSamples) float32 NumPy array, so that audio can be rendered into it in place.
+* The channels may be anywhere in memory, but the samples within each channel must be contiguous.
+*/
+static std::array<float*, 2> getChannelPointers(py::array& buffer)
+{
+    if (!py::isinstance<py::array_t<float>>(buffer))
+    {
+        throw std::runtime_error("Buffer must have dtype float32");
+    }
+
+    if (buffer.ndim() != 2)
+    {
+        throw std::runtime_error("Buffer must be 2-dimensional");
+    }
+
+    if (buffer.shape(0) != 2)
+    {
+        throw std::runtime_error("Buffer must have 2 channels");
+    }
+
+    if (buffer.strides(1) != sizeof(float))
+    {
+        throw std::runtime_error("The samples of each channel must be contiguous in memory");
+    }
+
+    auto* data = static_cast<char*>(buffer.mutable_data());
+    return {reinterpret_cast<float*>(data), reinterpret_cast<float*>(data + buffer.strides(0))};
+}
+
 class ResonariumVoiceWrapper
 {
 private:
     ResonatorVoice* wrappedVoice; // Raw pointer - ownership remains with the synth
-    juce::AudioBuffer<float> tempBuffer; // Buffer for processing
     double sampleRate;
     int blockSize;
 
 public:
     ResonariumVoiceWrapper(ResonatorVoice* voice, double sampleRate = 44100.0, int blockSize = 512)
-        : wrappedVoice(voice), tempBuffer(2, blockSize), sampleRate(sampleRate), blockSize(blockSize)
+        : wrappedVoice(voice), sampleRate(sampleRate), blockSize(blockSize)
     {
-        tempBuffer.clear();
     }
 
     ~ResonariumVoiceWrapper()
@@ -114,40 +164,46 @@ public:
         return wrappedVoice && wrappedVoice->isVoiceActive();
     }
 
-    py::array_t<float> processBlock(int numSamples = -1)
+    /**
+     * Renders a single block of at most blockSize samples.
+     * If an output array is given, the voice renders straight into it and it is returned; otherwise a new array is allocated.
+     */
+    py::array processBlock(int numSamples = -1, std::optional<py::array> out = std::nullopt)
     {
         // Default to using blockSize if numSamples is not specified
         if (numSamples <= 0)
             numSamples = blockSize;
 
-        // Create output buffer for Python
-        auto result = py::array_t<float>({2, numSamples});
-        py::buffer_info buf = result.request();
-        float* ptr = static_cast<float*>(buf.ptr);
+        if (numSamples > blockSize)
+        {
+            throw std::runtime_error(
+                "Number of samples (" + std::to_string(numSamples) + ") exceeds the block size (" +
+                std::to_string(blockSize) + ")");
+        }
 
-        // Clear the result buffer
-        std::memset(ptr, 0, 2 * numSamples * sizeof(float));
+        py::array result;
+        if (out.has_value())
+            result = *out;
+        else
+            result = py::array_t<float>({2, numSamples});
 
-        if (wrappedVoice && wrappedVoice->isVoiceActive())
+        auto channels = getChannelPointers(result);
+        if (result.shape(1) < numSamples)
         {
-            // Make sure tempBuffer is large enough
-            if (tempBuffer.getNumSamples() < numSamples)
-            {
-                tempBuffer.setSize(2, numSamples, false, true);
-            }
-
-            // Clear the buffer
-            tempBuffer.clear();
+            throw std::runtime_error("Output buffer is shorter than the number of samples to render");
+        }
 
-            // Process the audio
-            wrappedVoice->renderNextBlock(tempBuffer, 0, numSamples);
+        {
+            py::gil_scoped_release release;
 
-            // Copy to the output buffer
-            float* outL = ptr;
-            float* outR = ptr + numSamples;
+            // Refer to the NumPy memory directly, rather than rendering into a temporary buffer and copying
+            juce::AudioBuffer<float> outputBuffer(channels.data(), 2, numSamples);
+            outputBuffer.clear();
 
-            std::memcpy(outL, tempBuffer.getReadPointer(0), numSamples * sizeof(float));
-            std::memcpy(outR, tempBuffer.getReadPointer(1), numSamples * sizeof(float));
+            if (wrappedVoice && wrappedVoice->isVoiceActive())
+            {
+                wrappedVoice->renderNextBlock(outputBuffer, 0, numSamples);
+            }
         }
 
         return result;
@@ -155,31 +211,20 @@ public:
 
     /**
      * Process multiple blocks at once, similar to the processor's processMultiBlock.
-     * Fills the provided buffer with audio from the voice.
+     * Fills the provided buffer with audio from the voice, in place.
      */
-    void processMultiBlock(py::array_t<float>& buffer, int startBlock = 0, int numBlocks = -1)
+    void processMultiBlock(py::array& buffer, int startBlock = 0, int numBlocks = -1)
     {
-        py::buffer_info buf = buffer.request();
-
-        // Error checking
-        if (buf.ndim != 2)
-        {
-            throw std::runtime_error("Buffer must be 2-dimensional");
-        }
-
-        if (buf.shape[0] != 2)
-        {
-            throw std::runtime_error("Buffer must have 2 channels");
-        }
+        auto channels = getChannelPointers(buffer);
 
-        if (buf.shape[1] % blockSize != 0)
+        if (buffer.shape(1) % blockSize != 0)
         {
             throw std::runtime_error(
-                "Buffer length (" + std::to_string(buf.shape[1]) + ") must be multiple of block size (" +
+                "Buffer length (" + std::to_string(buffer.shape(1)) + ") must be multiple of block size (" +
                 std::to_string(blockSize) + ")");
         }
 
-        int maxBlocks = buf.shape[1] / blockSize;
+        int maxBlocks = buffer.shape(1) / blockSize;
         if (startBlock >= maxBlocks)
         {
             throw std::runtime_error("Start block beyond buffer end");
@@ -195,31 +240,16 @@ public:
         if (!wrappedVoice || !wrappedVoice->isVoiceActive())
             return;
 
-        // Get pointers to the buffer
-        float* outL = static_cast<float*>(buf.ptr) + startBlock * blockSize;
-        float* outR = outL + buf.shape[1];
+        py::gil_scoped_release release;
 
-        // Make sure tempBuffer is large enough
-        if (tempBuffer.getNumSamples() < blockSize)
-        {
-            tempBuffer.setSize(2, blockSize, false, true);
-        }
-
-        // Process each block
+        // Process each block straight into the NumPy memory
         for (int i = 0; i < blocksToProcess; ++i)
         {
-            // Clear audio buffer
-            tempBuffer.clear();
-
-            // Process audio with the voice
-            wrappedVoice->renderNextBlock(tempBuffer, 0, blockSize);
-
-            // Copy to output buffer
-            std::memcpy(outL, tempBuffer.getReadPointer(0), blockSize * sizeof(float));
-            std::memcpy(outR, tempBuffer.getReadPointer(1), blockSize * sizeof(float));
-
-            outL += blockSize;
-            outR += blockSize;
+            const int offset = (startBlock + i) * blockSize;
+            float* blockChannels[2] = {channels[0] + offset, channels[1] + offset};
+            juce::AudioBuffer<float> blockBuffer(blockChannels, 2, blockSize);
+            blockBuffer.clear();
+            wrappedVoice->renderNextBlock(blockBuffer, 0, blockSize);
         }
     }
 };
@@ -228,12 +258,10 @@ class ResonariumWrapper
 {
 private:
     std::unique_ptr<ResonariumProcessor> processor;
-    juce::AudioBuffer<float> tempBuffer; //holds a single block of memory
     juce::MidiBuffer midiBuffer;
 
 public:
     ResonariumWrapper(double sampleRate = 44100.0, int blockSize = 512)
-        : tempBuffer(2, blockSize)
     {
         processor = std::make_unique<ResonariumProcessor>();
         processor->prepareToPlay(sampleRate, blockSize);
@@ -341,6 +369,7 @@ public:
         }
 
         param->setUserValueNotifingHost(value);
+        processor->getSynth()->allocateResonatorMemory(); //in case a resonator was just enabled
     }
 
     /**
@@ -561,28 +590,22 @@ public:
     }
 
     // Audio Processing
-    void processMultiBlock(py::array_t<float>& buffer, int startBlock = 0, int numBlocks = -1)
+    /**
+     * Renders blocks straight into the given NumPy buffer, without any intermediate copies.
+     * The GIL is released for the whole render, so other Python threads can run meanwhile;
+     * they must not use this instance until the call returns.
+     */
+    void processMultiBlock(py::array& buffer, int startBlock = 0, int numBlocks = -1)
     {
-        py::buffer_info buf = buffer.request();
+        auto channels = getChannelPointers(buffer);
         const int blockSize = getBlockSize();
 
-        // Error checking
-        if (buf.ndim != 2)
-        {
-            throw std::runtime_error("Buffer must be 2-dimensional");
-        }
-
-        if (buf.shape[0] != 2)
-        {
-            throw std::runtime_error("Buffer must have 2 channels");
-        }
-
-        if (buf.shape[1] % blockSize != 0)
+        if (buffer.shape(1) % blockSize != 0)
         {
             throw std::runtime_error("Buffer length must be multiple of block size");
         }
 
-        int maxBlocks = buf.shape[1] / blockSize;
+        int maxBlocks = buffer.shape(1) / blockSize;
         if (startBlock >= maxBlocks)
         {
             throw std::runtime_error("Start block beyond buffer end");
@@ -594,29 +617,404 @@ public:
             throw std::runtime_error("Requested blocks exceed buffer size");
         }
 
-        // Get pointers to the buffer
-        float* outL = static_cast<float*>(buf.ptr) + startBlock * blockSize;
-        float* outR = outL + buf.shape[1];
+        py::gil_scoped_release release;
 
-        // Process each block
+        // Process each block with the accumulated MIDI events, into a buffer that refers to the NumPy memory
         for (int i = 0; i < blocksToProcess; ++i)
         {
-            // Clear audio buffer but keep MIDI events
-            tempBuffer.clear();
+            const int offset = (startBlock + i) * blockSize;
+            float* blockChannels[2] = {channels[0] + offset, channels[1] + offset};
+            juce::AudioBuffer<float> blockBuffer(blockChannels, 2, blockSize);
+            // whatever the caller left in the array would otherwise reach the external input exciter
+            blockBuffer.clear();
+            processor->processBlock(blockBuffer, midiBuffer);
+        }
 
-            // Process audio with accumulated MIDI events
-            processor->processBlock(tempBuffer, midiBuffer);
+        // Clear MIDI buffer after processing all blocks
+        midiBuffer.clear();
+    }
 
-            // Copy to output buffer
-            memcpy(outL, tempBuffer.getReadPointer(0), blockSize * sizeof(float));
-            memcpy(outR, tempBuffer.getReadPointer(1), blockSize * sizeof(float));
+    /**
+     * Renders a sequence of timestamped events in a single call, into a new (2, numSamples) array or into `out`.
+     * Each event is a tuple whose first two entries are the sample position and the event type:
+     *   (sample, "note_on", channel, note, velocity)
+     *   (sample, "note_off", channel, note)
+     *   (sample, "cc", channel, controller, value)
+     *   (sample, "pitch_bend", channel, value) with value in [0, 16383], 8192 being centred
+     *   (sample, "all_notes_off")
+     *   (sample, "param", parameter ID, value)
+     * MIDI events land on their exact sample. Parameter changes split the processor's block at their position,
+     * so they take effect on their exact sample too. MIDI queued with play_note etc. is played at sample 0.
+     */
+    py::array renderEvents(const std::vector<py::tuple>& eventTable, int numSamples, std::optional<py::array> out)
+    {
+        if (numSamples <= 0)
+        {
+            if (!out.has_value())
+            {
+                throw std::runtime_error("Number of samples must be given when no output buffer is");
+            }
+            numSamples = static_cast<int>(out->shape(1));
+        }
 
-            outL += blockSize;
-            outR += blockSize;
+        py::array result;
+        if (out.has_value())
+            result = *out;
+        else
+            result = py::array_t<float>({2, numSamples});
+
+        auto channels = getChannelPointers(result);
+        if (result.shape(1) < numSamples)
+        {
+            throw std::runtime_error("Output buffer is shorter than the number of samples to render");
         }
 
-        // Clear MIDI buffer after processing all blocks
+        std::vector<PyTimedEvent> events;
+        events.reserve(static_cast<size_t>(midiBuffer.getNumEvents()) + eventTable.size());
+        for (const auto metadata : midiBuffer)
+        {
+            events.push_back({0, metadata.getMessage()});
+        }
+
+        for (const auto& row : eventTable)
+        {
+            if (row.size() < 2)
+            {
+                throw std::runtime_error("Each event must start with (sample, type)");
+            }
+
+            const int sample = row[0].cast<int>();
+            const auto type = row[1].cast<std::string>();
+            if (sample < 0 || sample >= numSamples)
+            {
+                throw std::runtime_error("Event at sample " + std::to_string(sample) + " is outside of the render");
+            }
+
+            auto getArg = [&row, &type](size_t index)
+            {
+                if (index >= row.size())
+                {
+                    throw std::runtime_error("Missing arguments for event of type " + type);
+                }
+                return row[index];
+            };
+
+            // MIDI values are checked here, since juce::MidiMessage would silently truncate or assert on them
+            auto getMidiArg = [&getArg, &type](size_t index, const char* name, int maxValue)
+            {
+                const int value = getArg(index).cast<int>();
+                if (value < 0 || value > maxValue)
+                {
+                    throw py::value_error("The " + std::string(name) + " of a " + type + " event must be between 0 and " +
+                                          std::to_string(maxValue) + ", got " + std::to_string(value));
+                }
+                return value;
+            };
+
+            // channels are 0-based here, i.e. MIDI channels 1 to 16
+            if (type == "note_on")
+                events.push_back({sample, juce::MidiMessage::noteOn(getMidiArg(2, "channel", 15) + 1,
+                                                                    getMidiArg(3, "note", 127),
+                                                                    static_cast<juce::uint8>(getMidiArg(4, "velocity", 127)))});
+            else if (type == "note_off")
+                events.push_back({sample, juce::MidiMessage::noteOff(getMidiArg(2, "channel", 15) + 1,
+                                                                     getMidiArg(3, "note", 127))});
+            else if (type == "cc")
+                events.push_back({sample, juce::MidiMessage::controllerEvent(getMidiArg(2, "channel", 15) + 1,
+                                                                             getMidiArg(3, "controller", 127),
+                                                                             getMidiArg(4, "value", 127))});
+            else if (type == "pitch_bend")
+                events.push_back({sample, juce::MidiMessage::pitchWheel(getMidiArg(2, "channel", 15) + 1,
+                                                                        getMidiArg(3, "value", 16383))});
+            else if (type == "all_notes_off")
+            {
+                for (int channel = 1; channel <= 16; ++channel)
+                {
+                    events.push_back({sample, juce::MidiMessage::allNotesOff(channel)});
+                }
+            }
+            else if (type == "param")
+            {
+                const auto id = getArg(2).cast<std::string>();
+                const auto value = getArg(3).cast<float>();
+                gin::Parameter* param = processor->getParameter(id);
+                if (param == nullptr)
+                {
+                    throw std::runtime_error("Parameter not found: " + id);
+                }
+
+                if (value < param->getUserRangeStart() || value > param->getUserRangeEnd())
+                {
+                    throw std::runtime_error(
+                        "Parameter value " + std::to_string(value) + " for " + id + " is out of range; valid range is " +
+                        std::to_string(param->getUserRangeStart()) + " to " + std::to_string(param->getUserRangeEnd()));
+                }
+
+                events.push_back({sample, {}, param, value});
+            }
+            else
+            {
+                throw std::runtime_error("Unknown event type: " + type);
+            }
+        }
         midiBuffer.clear();
+
+        // events at the same sample keep the order they were given in
+        std::stable_sort(events.begin(), events.end(),
+                         [](const PyTimedEvent& a, const PyTimedEvent& b) { return a.sample < b.sample; });
+
+        {
+            py::gil_scoped_release release;
+
+            const int blockSize = getBlockSize();
+            juce::MidiBuffer blockMidi;
+            size_t nextEvent = 0;
+
+            for (int position = 0; position < numSamples;)
+            {
+                // collect this block's MIDI, and apply the parameter changes that are due now;
+                // a later parameter change ends the block early, so that it applies from its exact sample
+                int end = juce::jmin(position + blockSize, numSamples);
+                blockMidi.clear();
+                for (; nextEvent < events.size() && events[nextEvent].sample < end; nextEvent++)
+                {
+                    const auto& event = events[nextEvent];
+                    if (event.param != nullptr)
+                    {
+                        if (event.sample > position)
+                        {
+                            end = event.sample;
+                            break;
+                        }
+                        event.param->setUserValue(event.value);
+                        processor->getSynth()->allocateResonatorMemory();
+                    }
+                    else
+                    {
+                        blockMidi.addEvent(event.message, event.sample - position);
+                    }
+                }
+
+                float* blockChannels[2] = {channels[0] + position, channels[1] + position};
+                juce::AudioBuffer<float> blockBuffer(blockChannels, 2, end - position);
+                // neither a new array nor the caller's `out` is zeroed, and its contents would reach the external input exciter
+                blockBuffer.clear();
+                processor->processBlock(blockBuffer, blockMidi);
+                position = end;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * Renders a batch of notes, each on its own voice and into its own (2, numSamples) slice of an (N, 2, numSamples) array.
+     * Each row of the table is (note, velocity, duration) or (note, velocity, duration, {parameter ID: value}).
+     *
+     * Notes are rendered concurrently on the processor's thread pool, up to one note per voice at a time.
+     * Since parameters are shared by all voices, notes are grouped by their parameter overrides,
+     * and only notes with identical overrides are rendered at the same time.
+     * As with a single ResonatorVoice, only the voices are rendered: the global effect chain and mono modulation sources are not.
+     */
+    py::array_t<float> renderBatch(const std::vector<py::tuple>& table, int numSamples)
+    {
+        if (numSamples <= 0)
+        {
+            throw std::runtime_error("Number of samples must be positive");
+        }
+
+        // Parse and validate the whole table before touching the processor
+        std::vector<PyBatchNote> notes;
+        std::map<std::string, float> originalValues; // the values of every overridden parameter, restored afterwards
+        notes.reserve(table.size());
+        for (const auto& row : table)
+        {
+            if (row.size() != 3 && row.size() != 4)
+            {
+                throw std::runtime_error("Each row must be (note, velocity, duration) or (note, velocity, duration, overrides)");
+            }
+
+            PyBatchNote batchNote{row[0].cast<int>(), row[1].cast<int>(), row[2].cast<double>(), {}};
+            if (batchNote.note < 0 || batchNote.note > 127 || batchNote.velocity < 0 || batchNote.velocity > 127)
+            {
+                throw std::runtime_error("Notes and velocities must be between 0 and 127");
+            }
+
+            if (row.size() == 4 && !row[3].is_none())
+            {
+                for (const auto& [key, value] : row[3].cast<py::dict>())
+                {
+                    const auto id = key.cast<std::string>();
+                    const auto userValue = value.cast<float>();
+                    gin::Parameter* param = processor->getParameter(id);
+                    if (param == nullptr)
+                    {
+                        throw std::runtime_error("Parameter not found: " + id);
+                    }
+
+                    if (userValue < param->getUserRangeStart() || userValue > param->getUserRangeEnd())
+                    {
+                        throw std::runtime_error(
+                            "Parameter value " + std::to_string(userValue) + " for " + id + " is out of range; valid range is " +
+                            std::to_string(param->getUserRangeStart()) + " to " + std::to_string(param->getUserRangeEnd()));
+                    }
+
+                    batchNote.overrides.emplace_back(id, userValue);
+                    originalValues.emplace(id, param->getUserValue());
+                }
+                std::sort(batchNote.overrides.begin(), batchNote.overrides.end());
+            }
+            notes.push_back(std::move(batchNote));
+        }
+
+        std::map<std::vector<std::pair<std::string, float>>, std::vector<int>> groups;
+        for (int i = 0; i < static_cast<int>(notes.size()); i++)
+        {
+            groups[notes[static_cast<size_t>(i)].overrides].push_back(i);
+        }
+
+        auto result = py::array_t<float>({static_cast<py::ssize_t>(notes.size()), py::ssize_t{2},
+                                          static_cast<py::ssize_t>(numSamples)});
+        float* output = result.mutable_data();
+        //the batch is always rendered in parallel, whether or not multithreaded rendering is switched on
+        processor->createThreadPool();
+
+        {
+            py::gil_scoped_release release;
+
+            auto* synth = processor->getSynth();
+            auto* threadPool = processor->globalState.threadPool.load(std::memory_order_acquire);
+            const int blockSize = getBlockSize();
+            const double sampleRate = getSampleRate();
+            const int numVoices = juce::jmin(synth->getNumVoices(), 64);
+            synth->turnOffAllVoices(false);
+
+            std::array<ResonatorVoice*, 64> waveVoices {};
+            std::array<int, 64> waveNotes {};
+
+            auto renderNote = [&](int i)
+            {
+                auto* voice = waveVoices[static_cast<size_t>(i)];
+                const auto noteIndex = static_cast<size_t>(waveNotes[static_cast<size_t>(i)]);
+                const auto& batchNote = notes[noteIndex];
+                float* channels[2] = {output + 2 * noteIndex * static_cast<size_t>(numSamples),
+                                      output + (2 * noteIndex + 1) * static_cast<size_t>(numSamples)};
+                const int noteOffSample = juce::roundToInt(batchNote.duration * sampleRate);
+                bool released = false;
+
+                for (int start = 0; start < numSamples;)
+                {
+                    if (voice->stopPending)
+                    {
+                        // the voice has gone silent; the rest of the note is silence
+                        juce::FloatVectorOperations::clear(channels[0] + start, numSamples - start);
+                        juce::FloatVectorOperations::clear(channels[1] + start, numSamples - start);
+                        break;
+                    }
+
+                    if (!released && start >= noteOffSample)
+                    {
+                        voice->noteStopped(true);
+                        released = true;
+                    }
+
+                    // split the block at the note-off, so that the release is sample-accurate
+                    int blockLength = juce::jmin(blockSize, numSamples - start);
+                    if (!released) blockLength = juce::jmin(blockLength, noteOffSample - start);
+
+                    float* blockChannels[2] = {channels[0] + start, channels[1] + start};
+                    juce::AudioBuffer<float> blockBuffer(blockChannels, 2, blockLength);
+                    blockBuffer.clear();
+                    voice->renderNextBlock(blockBuffer, 0, blockLength);
+                    start += blockLength;
+                }
+            };
+
+            for (const auto& [overrides, group] : groups)
+            {
+                for (const auto& [id, value] : originalValues)
+                {
+                    processor->getParameter(id)->setUserValue(value);
+                }
+                for (const auto& [id, value] : overrides)
+                {
+                    processor->getParameter(id)->setUserValue(value);
+                }
+                synth->allocateResonatorMemory();
+
+                // render in waves of up to one note per voice; voices are started and stopped on this thread
+                for (size_t waveStart = 0; waveStart < group.size(); waveStart += static_cast<size_t>(numVoices))
+                {
+                    const int waveSize = static_cast<int>(juce::jmin(group.size() - waveStart, static_cast<size_t>(numVoices)));
+                    for (int i = 0; i < waveSize; i++)
+                    {
+                        const int noteIndex = group[waveStart + static_cast<size_t>(i)];
+                        const auto& batchNote = notes[static_cast<size_t>(noteIndex)];
+                        auto* voice = dynamic_cast<ResonatorVoice*>(synth->getVoice(i));
+                        voice->setCurrentlyPlayingNote(juce::MPENote(
+                            1 + i % 15,
+                            batchNote.note,
+                            juce::MPEValue::from7BitInt(batchNote.velocity), //velocity
+                            juce::MPEValue::centreValue(), //pitchbend
+                            juce::MPEValue::minValue(), //pressure
+                            juce::MPEValue::centreValue(), //timbre
+                            juce::MPENote::keyDown));
+                        voice->noteStarted();
+                        voice->deferStops = true;
+                        waveVoices[static_cast<size_t>(i)] = voice;
+                        waveNotes[static_cast<size_t>(i)] = noteIndex;
+                    }
+
+                    if (threadPool != nullptr)
+                    {
+                        threadPool->run(waveSize, renderNote);
+                    }
+                    else
+                    {
+                        for (int i = 0; i < waveSize; i++) renderNote(i);
+                    }
+
+                    for (int i = 0; i < waveSize; i++)
+                    {
+                        auto* voice = waveVoices[static_cast<size_t>(i)];
+                        voice->deferStops = false;
+                        voice->finishPendingStop();
+                        if (voice->isVoiceActive()) voice->noteStopped(false);
+                    }
+                }
+            }
+
+            for (const auto& [id, value] : originalValues)
+            {
+                processor->getParameter(id)->setUserValue(value);
+            }
+        }
+
+        return result;
+    }
+
+    // Per-block timings of each render stage since the last reset, in nanoseconds
+    py::dict getStageProfile() const
+    {
+        auto& profiler = processor->globalState.profiler;
+        py::dict profile;
+        for (int s = 0; s < StageProfiler::numStages; s++)
+        {
+            const auto stage = static_cast<StageProfiler::Stage>(s);
+            const auto statistics = profiler.getStatistics(stage);
+            py::dict entry;
+            entry["min_ns"] = statistics.minNanoseconds;
+            entry["avg_ns"] = statistics.averageNanoseconds;
+            entry["max_ns"] = statistics.maxNanoseconds;
+            entry["blocks"] = statistics.numBlocks;
+            profile[StageProfiler::getStageName(stage)] = entry;
+        }
+        return profile;
+    }
+
+    void resetStageProfile()
+    {
+        processor->globalState.profiler.reset();
     }
 
     // Acquire a voice wrapper
@@ -673,7 +1071,8 @@ PYBIND11_MODULE(resonarium, m)
         .def("release_note", &ResonariumVoiceWrapper::releaseNote)
         .def("is_active", &ResonariumVoiceWrapper::isActive)
         .def("process_block", &ResonariumVoiceWrapper::processBlock,
-             py::arg("num_samples") = -1)
+             py::arg("num_samples") = -1,
+             py::arg("out") = py::none())
         .def("process_multi_block", &ResonariumVoiceWrapper::processMultiBlock,
              py::arg("buffer"),
              py::arg("startBlock") = 0,
@@ -714,7 +1113,16 @@ PYBIND11_MODULE(resonarium, m)
         .def("release_note", &ResonariumWrapper::releaseNote,
              py::arg("channel"), py::arg("note"), py::arg("velocity") = 0)
         .def("all_notes_off", &ResonariumWrapper::allNotesOff)
+        .def("render_events", &ResonariumWrapper::renderEvents,
+             py::arg("events"),
+             py::arg("num_samples") = -1,
+             py::arg("out") = py::none())
+        .def("render_batch", &ResonariumWrapper::renderBatch,
+             py::arg("notes"),
+             py::arg("num_samples"))
         // Voice management
+        .def("get_stage_profile", &ResonariumWrapper::getStageProfile)
+        .def("reset_stage_profile", &ResonariumWrapper::resetStageProfile)
         .def("get_voice", &ResonariumWrapper::getVoice, py::arg("index") = 0);
 
     m.def("get_version", []() { return "0.1.0"; });
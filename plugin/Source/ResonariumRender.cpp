@@ -0,0 +1,288 @@
+#include <iostream>
+#include "PluginProcessor.h"
+
+/**
+ * Resonarium_Render: renders presets against MIDI files to audio files, offline and faster than real time.
+ *
+ * Usage: Resonarium_Render --preset <file.xml or directory> [--preset ...] --midi <file.mid or directory> [--midi ...]
+ *                          [--output <directory>] [--format wav|flac] [--sample-rate <Hz>] [--block-size <samples>]
+ *                          [--bit-depth <16|24|32>] [--tail <seconds>] [--threads <n>]
+ *
+ * Every preset is rendered against every MIDI file, to "<preset> - <midi file>.<format>" in the output directory.
+ * Each render thread owns a headless ResonariumProcessor, so no editor or LookAndFeel is ever created,
+ * and renders are spread across all cores by default.
+ */
+
+namespace
+{
+    struct RenderSettings
+    {
+        juce::File outputDirectory = juce::File::getCurrentWorkingDirectory();
+        juce::String format = "wav";
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int bitDepth = 24;
+        double maxTailSeconds = 10.0; //how long to keep rendering after the last MIDI event, at most
+        int numThreads = juce::SystemStats::getNumCpus();
+    };
+
+    struct RenderJob
+    {
+        juce::File preset;
+        juce::File midiFile;
+        juce::File outputFile;
+    };
+
+    juce::Array<juce::File> findFiles(const juce::StringArray& paths, const juce::String& wildcard)
+    {
+        juce::Array<juce::File> files;
+        for (const auto& path : paths)
+        {
+            const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+            if (file.isDirectory())
+            {
+                auto children = file.findChildFiles(juce::File::findFiles, false, wildcard);
+                children.sort();
+                files.addArray(children);
+            }
+            else
+            {
+                files.add(file);
+            }
+        }
+        return files;
+    }
+
+    /**
+     * Reads every track of a MIDI file into a single sequence, timestamped in seconds.
+     */
+    bool readMidiFile(const juce::File& file, juce::MidiMessageSequence& sequence)
+    {
+        juce::FileInputStream stream(file);
+        juce::MidiFile midiFile;
+        if (!stream.openedOk() || !midiFile.readFrom(stream))
+            return false;
+
+        midiFile.convertTimestampTicksToSeconds();
+        for (int i = 0; i < midiFile.getNumTracks(); i++)
+        {
+            sequence.addSequence(*midiFile.getTrack(i), 0.0);
+        }
+        sequence.updateMatchedPairs();
+        return true;
+    }
+
+    std::unique_ptr<juce::AudioFormat> createFormat(const juce::String& name)
+    {
+        if (name == "flac") return std::make_unique<juce::FlacAudioFormat>();
+        return std::make_unique<juce::WavAudioFormat>();
+    }
+
+    /**
+     * Renders one preset against one MIDI file, from a freshly prepared processor.
+     * After the last MIDI event, rendering continues until every voice has stopped and the output is silent,
+     * or until the maximum tail length is reached.
+     */
+    juce::Result render(ResonariumProcessor& processor, const RenderJob& job, const RenderSettings& settings)
+    {
+        juce::MidiMessageSequence sequence;
+        if (!readMidiFile(job.midiFile, sequence))
+            return juce::Result::fail("could not read MIDI file " + job.midiFile.getFullPathName());
+
+        if (!processor.loadPresetFile(job.preset))
+            return juce::Result::fail("could not load preset " + job.preset.getFullPathName());
+
+        //each worker's processor is reused from job to job, so everything the previous render left behind
+        //(effect tails, modulation source phases, voices) is cleared: every file renders as if it were the first
+        processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+
+        const int blockSize = settings.blockSize;
+        const auto lastEventSample = static_cast<juce::int64>(std::ceil(sequence.getEndTime() * settings.sampleRate));
+        const auto maxLength = lastEventSample + static_cast<juce::int64>(settings.maxTailSeconds * settings.sampleRate);
+        const int maxNumBlocks = static_cast<int>(maxLength / blockSize) + 1;
+
+        juce::AudioBuffer<float> output(2, maxNumBlocks * blockSize);
+        juce::AudioBuffer<float> block(2, blockSize);
+        juce::MidiBuffer midi;
+        int nextEvent = 0;
+        int numBlocks = 0;
+
+        for (; numBlocks < maxNumBlocks; numBlocks++)
+        {
+            const juce::int64 blockStart = static_cast<juce::int64>(numBlocks) * blockSize;
+            midi.clear();
+            for (; nextEvent < sequence.getNumEvents(); nextEvent++)
+            {
+                const auto& message = sequence.getEventPointer(nextEvent)->message;
+                const auto eventSample = static_cast<juce::int64>(message.getTimeStamp() * settings.sampleRate);
+                if (eventSample >= blockStart + blockSize) break;
+                midi.addEvent(message, static_cast<int>(juce::jmax<juce::int64>(0, eventSample - blockStart)));
+            }
+
+            block.clear();
+            processor.processBlock(block, midi);
+            output.copyFrom(0, numBlocks * blockSize, block, 0, 0, blockSize);
+            output.copyFrom(1, numBlocks * blockSize, block, 1, 0, blockSize);
+
+            const bool pastLastEvent = nextEvent >= sequence.getNumEvents() && blockStart + blockSize > lastEventSample;
+            if (pastLastEvent && processor.synth.getNumActiveVoices() == 0
+                && block.getMagnitude(0, blockSize) < juce::Decibels::decibelsToGain(-96.0f))
+            {
+                numBlocks++;
+                break;
+            }
+        }
+
+        job.outputFile.getParentDirectory().createDirectory();
+        job.outputFile.deleteFile();
+        auto format = createFormat(settings.format);
+        std::unique_ptr<juce::AudioFormatWriter> writer(
+            format->createWriterFor(new juce::FileOutputStream(job.outputFile), settings.sampleRate, 2,
+                                    settings.bitDepth, {}, 0));
+        if (writer == nullptr)
+            return juce::Result::fail("could not write " + job.outputFile.getFullPathName());
+
+        writer->writeFromAudioSampleBuffer(output, 0, numBlocks * blockSize);
+        return juce::Result::ok();
+    }
+
+    /**
+     * A render thread: owns a headless processor, and renders jobs from the shared list until none are left.
+     */
+    class RenderWorker : public juce::ThreadPoolJob
+    {
+    public:
+        RenderWorker(std::unique_ptr<ResonariumProcessor> processor, const juce::Array<RenderJob>& jobs,
+                     std::atomic<int>& nextJob, std::atomic<int>& numFailed, const RenderSettings& settings) :
+            juce::ThreadPoolJob("Resonarium Render Worker"),
+            processor(std::move(processor)), jobs(jobs), nextJob(nextJob), numFailed(numFailed), settings(settings)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            for (int i = nextJob.fetch_add(1); i < jobs.size() && !shouldExit(); i = nextJob.fetch_add(1))
+            {
+                const auto& job = jobs.getReference(i);
+                const auto result = render(*processor, job, settings);
+
+                const juce::ScopedLock sl(outputLock);
+                if (result.wasOk())
+                {
+                    std::cout << "[" << (i + 1) << "/" << jobs.size() << "] " << job.outputFile.getFullPathName() << std::endl;
+                }
+                else
+                {
+                    numFailed++;
+                    std::cerr << "[" << (i + 1) << "/" << jobs.size() << "] failed: " << result.getErrorMessage() << std::endl;
+                }
+            }
+            return jobHasFinished;
+        }
+
+    private:
+        static juce::CriticalSection outputLock;
+
+        std::unique_ptr<ResonariumProcessor> processor;
+        const juce::Array<RenderJob>& jobs;
+        std::atomic<int>& nextJob;
+        std::atomic<int>& numFailed;
+        const RenderSettings& settings;
+    };
+
+    juce::CriticalSection RenderWorker::outputLock;
+
+    void printUsage()
+    {
+        std::cerr << "Usage: Resonarium_Render --preset <file.xml or directory> [--preset ...]"
+            " --midi <file.mid or directory> [--midi ...]\n"
+            "                         [--output <directory>] [--format wav|flac] [--sample-rate <Hz>]"
+            " [--block-size <samples>]\n"
+            "                         [--bit-depth <16|24|32>] [--tail <seconds>] [--threads <n>]" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    RenderSettings settings;
+    juce::StringArray presetPaths, midiPaths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const juce::String arg(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--preset" && hasValue)
+            presetPaths.add(argv[++i]);
+        else if (arg == "--midi" && hasValue)
+            midiPaths.add(argv[++i]);
+        else if (arg == "--output" && hasValue)
+            settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        else if (arg == "--format" && hasValue)
+            settings.format = juce::String(argv[++i]).toLowerCase();
+        else if (arg == "--sample-rate" && hasValue)
+            settings.sampleRate = juce::String(argv[++i]).getDoubleValue();
+        else if (arg == "--block-size" && hasValue)
+            settings.blockSize = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--bit-depth" && hasValue)
+            settings.bitDepth = juce::String(argv[++i]).getIntValue();
+        else if (arg == "--tail" && hasValue)
+            settings.maxTailSeconds = juce::jmax(0.0, juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--threads" && hasValue)
+            settings.numThreads = juce::String(argv[++i]).getIntValue();
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (presetPaths.isEmpty() || midiPaths.isEmpty() || settings.sampleRate <= 0.0 || settings.blockSize <= 0
+        || settings.numThreads <= 0 || (settings.format != "wav" && settings.format != "flac"))
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto presets = findFiles(presetPaths, "*.xml");
+    const auto midiFiles = findFiles(midiPaths, "*.mid;*.midi");
+    const auto extension = "." + settings.format;
+
+    juce::Array<RenderJob> jobs;
+    for (const auto& preset : presets)
+    {
+        for (const auto& midiFile : midiFiles)
+        {
+            const auto name = juce::File::createLegalFileName(
+                preset.getFileNameWithoutExtension() + " - " + midiFile.getFileNameWithoutExtension());
+            jobs.add({preset, midiFile, settings.outputDirectory.getChildFile(name + extension)});
+        }
+    }
+
+    //processors are created up front on the main thread, one per render thread, and reused from job to job;
+    //render() prepares them again before every job
+    const int numThreads = juce::jmin(settings.numThreads, jobs.size());
+    std::atomic<int> nextJob {0};
+    std::atomic<int> numFailed {0};
+    juce::ThreadPool threadPool(juce::ThreadPoolOptions().withThreadName("Resonarium Render")
+                                                          .withNumberOfThreads(numThreads));
+    for (int i = 0; i < numThreads; i++)
+    {
+        auto processor = std::make_unique<ResonariumProcessor>(true);
+        processor->setRateAndBufferSizeDetails(settings.sampleRate, settings.blockSize);
+        processor->prepareToPlay(settings.sampleRate, settings.blockSize);
+        threadPool.addJob(new RenderWorker(std::move(processor), jobs, nextJob, numFailed, settings), true);
+    }
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    while (threadPool.getNumJobs() > 0)
+    {
+        juce::Thread::sleep(50);
+    }
+    const auto elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+    std::cout << "Rendered " << (jobs.size() - numFailed.load()) << " of " << jobs.size() << " files in "
+        << elapsedSeconds << " s" << std::endl;
+    return numFailed.load() == 0 ? 0 : 1;
+}
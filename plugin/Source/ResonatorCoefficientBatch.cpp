@@ -0,0 +1,74 @@
+#include "ResonatorCoefficientBatch.h"
+
+namespace
+{
+    using Batch = FastMath::Batch;
+    constexpr int batchSize = static_cast<int>(Batch::size);
+    static_assert(ResonatorCoefficientBatch::maxLanes % batchSize == 0);
+
+    constexpr float log2OfOneThousandth = -9.9657842846620870f; //log2(0.001), i.e. a decay of 60 dB
+}
+
+int ResonatorCoefficientBatch::addLane() noexcept
+{
+    jassert(numLanes < maxLanes);
+    setNeutral(numLanes);
+    return numLanes++;
+}
+
+void ResonatorCoefficientBatch::setNeutral(int lane) noexcept
+{
+    voiceFrequency[lane] = 440.0f;
+    postFilterKeytrack[lane] = 0.0f;
+    postFilterSemitones[lane] = 0.0f;
+    postFilterCutoff[lane] = 1000.0f;
+    resonatorFrequency[lane] = 440.0f;
+    decayInSeconds[lane] = 1.0f;
+    loopFilterKeytrack[lane] = 0.0f;
+    loopFilterSemitones[lane] = 0.0f;
+    loopFilterCutoff[lane] = 1000.0f;
+    dispersion[lane] = 0.0f;
+}
+
+void ResonatorCoefficientBatch::compute(float sampleRate) noexcept
+{
+    const int numPaddedLanes = (numLanes + batchSize - 1) / batchSize * batchSize;
+    for (int l = numLanes; l < numPaddedLanes; l++)
+    {
+        setNeutral(l);
+    }
+
+    const Batch zero(0.0f);
+    const Batch oneTwelfth(1.0f / 12.0f);
+    const Batch minCutoff(1.0f);
+    const Batch maxCutoff(sampleRate * 0.49f);
+    const Batch piOverSampleRate(juce::MathConstants<float>::pi / sampleRate);
+
+    for (int l = 0; l < numPaddedLanes; l += batchSize)
+    {
+        const auto postFilterKeytracked = xsimd::load_aligned(voiceFrequency + l)
+            * FastMath::exp2(xsimd::load_aligned(postFilterSemitones + l) * oneTwelfth);
+        xsimd::select(xsimd::load_aligned(postFilterKeytrack + l) != zero,
+                      postFilterKeytracked,
+                      xsimd::load_aligned(postFilterCutoff + l)).store_aligned(postFilterCutoffOut + l);
+
+        //pow(0.001, 1 / (decay * frequency)) == 2^(log2(0.001) / (decay * frequency))
+        const auto frequency = xsimd::load_aligned(resonatorFrequency + l);
+        FastMath::exp2(Batch(log2OfOneThousandth) / (xsimd::load_aligned(decayInSeconds + l) * frequency))
+            .store_aligned(decayCoefficientOut + l);
+
+        const auto loopFilterKeytracked = frequency
+            * FastMath::exp2(xsimd::load_aligned(loopFilterSemitones + l) * oneTwelfth);
+        const auto cutoff = xsimd::select(xsimd::load_aligned(loopFilterKeytrack + l) != zero,
+                                          loopFilterKeytracked,
+                                          xsimd::load_aligned(loopFilterCutoff + l));
+        cutoff.store_aligned(loopFilterCutoffOut + l);
+        FastMath::tan(xsimd::clip(cutoff, minCutoff, maxCutoff) * piOverSampleRate)
+            .store_aligned(loopFilterPrewarpOut + l);
+
+        const auto angle = xsimd::clip(xsimd::load_aligned(dispersion + l), zero, Batch(1.0f))
+            * Batch(-juce::MathConstants<float>::halfPi);
+        FastMath::cos(angle).store_aligned(dispersionCosOut + l);
+        FastMath::sin(angle).store_aligned(dispersionSinOut + l);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef RESONATORCOEFFICIENTBATCH_H
+#define RESONATORCOEFFICIENTBATCH_H
+
+#include "defines.h"
+#include "dsp/FastMath.h"
+
+/**
+ * Computes the coefficients of several Resonators at once, one SIMD lane per Resonator channel.
+ *
+ * The transcendental part of a parameter update (keytracked cutoffs, decay coefficient, loop filter prewarp,
+ * dispersion rotation) is the bulk of its cost, and the same for every resonator, so it is gathered here and
+ * computed with the FastMath approximations on whole batches instead of per channel with std::pow, std::tan and co.
+ *
+ * Usage, once per block: clear(), then for every resonator channel addLane() and fill in its inputs,
+ * then compute(), and read back each lane's outputs. See Resonator::beginUpdate() and Resonator::finishUpdate().
+ */
+class ResonatorCoefficientBatch
+{
+public:
+    static constexpr int maxLanes = (2 * NUM_RESONATORS + 15) / 16 * 16;
+
+    void clear() noexcept { numLanes = 0; }
+
+    /**
+     * Adds a lane with neutral inputs, and returns its index.
+     */
+    int addLane() noexcept;
+    int getNumLanes() const noexcept { return numLanes; }
+
+    void compute(float sampleRate) noexcept;
+
+    //inputs
+    alignas(64) float voiceFrequency[maxLanes];
+    alignas(64) float postFilterKeytrack[maxLanes]; //1 if the post filter cutoff is keytracked, 0 otherwise
+    alignas(64) float postFilterSemitones[maxLanes]; //relative to the voice frequency, if keytracked
+    alignas(64) float postFilterCutoff[maxLanes]; //in Hz, if not keytracked
+    alignas(64) float resonatorFrequency[maxLanes];
+    alignas(64) float decayInSeconds[maxLanes];
+    alignas(64) float loopFilterKeytrack[maxLanes]; //1 if the loop filter cutoff is keytracked, 0 otherwise
+    alignas(64) float loopFilterSemitones[maxLanes]; //relative to the resonator frequency, if keytracked
+    alignas(64) float loopFilterCutoff[maxLanes]; //in Hz, if not keytracked
+    alignas(64) float dispersion[maxLanes];
+
+    //outputs
+    alignas(64) float postFilterCutoffOut[maxLanes];
+    alignas(64) float decayCoefficientOut[maxLanes];
+    alignas(64) float loopFilterCutoffOut[maxLanes];
+    alignas(64) float loopFilterPrewarpOut[maxLanes]; //tan(pi * cutoff / sampleRate), with the cutoff clamped below Nyquist
+    alignas(64) float dispersionCosOut[maxLanes];
+    alignas(64) float dispersionSinOut[maxLanes];
+
+private:
+    void setNeutral(int lane) noexcept;
+
+    int numLanes = 0;
+};
+
+#endif //RESONATORCOEFFICIENTBATCH_H
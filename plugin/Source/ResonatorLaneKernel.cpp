@@ -0,0 +1,140 @@
+#include "ResonatorLaneKernel.h"
+
+namespace
+{
+    using Batch = xsimd::batch<float>;
+    constexpr int batchSize = static_cast<int>(Batch::size);
+}
+
+template <int MaxLanes>
+void ResonatorLaneKernel<MaxLanes>::addLane(StereoResonator::Resonator& resonator) noexcept
+{
+    jassert(numLanes < maxLanes);
+    jassert(!resonator.passthrough);
+    lanes[static_cast<size_t>(numLanes++)] = &resonator;
+}
+
+template <int MaxLanes>
+void ResonatorLaneKernel<MaxLanes>::load() noexcept
+{
+    numPaddedLanes = (numLanes + batchSize - 1) / batchSize * batchSize;
+
+    for (int l = 0; l < numLanes; l++)
+    {
+        const auto& r = *lanes[static_cast<size_t>(l)];
+        a1[l] = r.loopFilter.a1;
+        a2[l] = r.loopFilter.a2;
+        a3[l] = r.loopFilter.a3;
+        k[l] = r.loopFilter.k;
+        lowpassMult[l] = r.loopFilter.lowpassMult;
+        bandpassMult[l] = r.loopFilter.bandpassMult;
+        highpassMult[l] = r.loopFilter.highpassMult;
+        ic1eq[l] = r.loopFilter.ic1eq;
+        ic2eq[l] = r.loopFilter.ic2eq;
+        apfC[l] = r.apf.c;
+        apfS[l] = r.apf.s;
+        apfState[l] = r.apf.state[1];
+        decay[l] = r.decayCoefficient;
+    }
+
+    //padding lanes compute silence
+    for (int l = numLanes; l < numPaddedLanes; l++)
+    {
+        tap0[l] = tap1[l] = tap2[l] = tap3[l] = frac[l] = 0.0f;
+        a1[l] = a2[l] = a3[l] = k[l] = 0.0f;
+        lowpassMult[l] = bandpassMult[l] = highpassMult[l] = 0.0f;
+        ic1eq[l] = ic2eq[l] = 0.0f;
+        apfC[l] = apfS[l] = apfState[l] = 0.0f;
+        decay[l] = 0.0f;
+    }
+}
+
+template <int MaxLanes>
+const float* ResonatorLaneKernel<MaxLanes>::popSamples() noexcept
+{
+    //gather: each lane reads its own interpolation taps
+    for (int l = 0; l < numLanes; l++)
+    {
+        auto& r = *lanes[static_cast<size_t>(l)];
+        r.delayLine.setDelay(r.delayLengthInterpolator.nextValue());
+        int delayInt;
+        float delayFrac;
+        ResonatorDelayLine::splitDelay(r.delayLine.getDelay(), delayInt, delayFrac);
+        const float* x = r.delayLine.getReadPointer() + delayInt;
+        tap0[l] = x[0];
+        tap1[l] = x[1];
+        tap2[l] = x[2];
+        tap3[l] = x[3];
+        frac[l] = delayFrac;
+    }
+
+    const Batch one(1.0f), two(2.0f), three(3.0f), half(0.5f), sixth(1.0f / 6.0f);
+    for (int l = 0; l < numPaddedLanes; l += batchSize)
+    {
+        //third-order Lagrange interpolation, see ResonatorDelayLine::interpolate
+        const auto f = xsimd::load_aligned(frac + l);
+        const auto d1 = f - one;
+        const auto d2 = f - two;
+        const auto d3 = f - three;
+        const auto c1 = -d1 * d2 * d3 * sixth;
+        const auto c2 = d2 * d3 * half;
+        const auto c3 = -d1 * d3 * half;
+        const auto c4 = d1 * d2 * sixth;
+        const auto x = xsimd::load_aligned(tap0 + l) * c1
+                       + f * (xsimd::load_aligned(tap1 + l) * c2
+                              + xsimd::load_aligned(tap2 + l) * c3
+                              + xsimd::load_aligned(tap3 + l) * c4);
+
+        //loop filter, see WaveguideLoopFilter::processSample
+        auto s1 = xsimd::load_aligned(ic1eq + l);
+        auto s2 = xsimd::load_aligned(ic2eq + l);
+        const auto coeffA2 = xsimd::load_aligned(a2 + l);
+        const auto v3 = x - s2;
+        const auto v1 = xsimd::load_aligned(a1 + l) * s1 + coeffA2 * v3;
+        const auto v2 = s2 + coeffA2 * s1 + xsimd::load_aligned(a3 + l) * v3;
+        s1 = two * v1 - s1;
+        s2 = two * v2 - s2;
+        s1.store_aligned(ic1eq + l);
+        s2.store_aligned(ic2eq + l);
+        const auto filtered = xsimd::load_aligned(lowpassMult + l) * v2
+                              + xsimd::load_aligned(bandpassMult + l) * v1
+                              + xsimd::load_aligned(highpassMult + l) * (x - xsimd::load_aligned(k + l) * v1 - v2);
+
+        //dispersion allpass, see DispersionFilter::processSample
+        const auto c = xsimd::load_aligned(apfC + l);
+        const auto s = xsimd::load_aligned(apfS + l);
+        const auto state = xsimd::load_aligned(apfState + l);
+        const auto dispersed = s * filtered + c * state;
+        (c * filtered - s * state).store_aligned(apfState + l);
+
+        (dispersed * xsimd::load_aligned(decay + l)).store_aligned(output + l);
+    }
+
+    return output;
+}
+
+template <int MaxLanes>
+void ResonatorLaneKernel<MaxLanes>::pushSamples(const float* input) noexcept
+{
+    for (int l = 0; l < numLanes; l++)
+    {
+        jassert(!std::isnan(input[l]));
+        lanes[static_cast<size_t>(l)]->delayLine.pushSample(input[l]);
+    }
+}
+
+template <int MaxLanes>
+void ResonatorLaneKernel<MaxLanes>::store() noexcept
+{
+    for (int l = 0; l < numLanes; l++)
+    {
+        auto& r = *lanes[static_cast<size_t>(l)];
+        r.loopFilter.ic1eq = ic1eq[l];
+        r.loopFilter.ic2eq = ic2eq[l];
+        r.apf.state[0] = apfState[l];
+        r.apf.state[1] = apfState[l];
+    }
+}
+
+template class ResonatorLaneKernel<2 * NUM_RESONATORS>;
+template class ResonatorLaneKernel<VOICE_GROUP_SIZE * 2 * NUM_RESONATORS>;
@@ -0,0 +1,87 @@
+#ifndef RESONATORLANEKERNEL_H
+#define RESONATORLANEKERNEL_H
+
+#include "defines.h"
+#include "StereoResonator.h"
+
+/**
+ * Runs the waveguide loops of several Resonators in lockstep, one SIMD lane per Resonator.
+ *
+ * The per-sample state that the loop touches (interpolation taps, loop filter state and coefficients,
+ * dispersion allpass state and coefficients, decay coefficients) is kept in a structure-of-arrays layout,
+ * so that everything after the delay-line read is computed with xsimd batches.
+ * The delay-line reads and writes themselves are per-lane gathers/scatters, since every lane has its own delay length.
+ *
+ * Usage, once per block: clear(), addLane() for every resonator channel, load(),
+ * then popSamples()/pushSamples() once per sample, and finally store() to hand the filter state back to the Resonators.
+ * Passthrough resonators must not be added as lanes.
+ *
+ * The lanes may come from any resonators, in any number of voices: a bank uses one lane per resonator channel
+ * (BankLaneKernel), and the VoiceGroupRenderer one lane per resonator channel of several voices (VoiceGroupLaneKernel).
+ */
+template <int MaxLanes>
+class ResonatorLaneKernel
+{
+public:
+    static constexpr int maxLanes = MaxLanes;
+    static_assert(maxLanes % 16 == 0, "Lane count must be a multiple of the widest SIMD batch");
+
+    void clear() noexcept { numLanes = 0; }
+    void addLane(StereoResonator::Resonator& resonator) noexcept;
+    int getNumLanes() const noexcept { return numLanes; }
+
+    /**
+     * Copies the coefficients and filter state of every lane into the kernel.
+     */
+    void load() noexcept;
+
+    /**
+     * Pops one sample from every lane's delay line and runs it through the loop filter, dispersion filter and decay.
+     * Equivalent to calling Resonator::popSample() on every lane.
+     * @return a pointer to getNumLanes() output samples, valid until the next call.
+     */
+    const float* popSamples() noexcept;
+
+    /**
+     * Pushes one sample into every lane's delay line. input must hold getNumLanes() samples.
+     */
+    void pushSamples(const float* input) noexcept;
+
+    /**
+     * Copies the filter state of every lane back into its Resonator.
+     */
+    void store() noexcept;
+
+private:
+    std::array<StereoResonator::Resonator*, maxLanes> lanes{};
+    int numLanes = 0;
+    int numPaddedLanes = 0;
+
+    alignas(64) float tap0[maxLanes]{};
+    alignas(64) float tap1[maxLanes]{};
+    alignas(64) float tap2[maxLanes]{};
+    alignas(64) float tap3[maxLanes]{};
+    alignas(64) float frac[maxLanes]{};
+
+    alignas(64) float a1[maxLanes]{};
+    alignas(64) float a2[maxLanes]{};
+    alignas(64) float a3[maxLanes]{};
+    alignas(64) float k[maxLanes]{};
+    alignas(64) float lowpassMult[maxLanes]{};
+    alignas(64) float bandpassMult[maxLanes]{};
+    alignas(64) float highpassMult[maxLanes]{};
+    alignas(64) float ic1eq[maxLanes]{};
+    alignas(64) float ic2eq[maxLanes]{};
+
+    alignas(64) float apfC[maxLanes]{};
+    alignas(64) float apfS[maxLanes]{};
+    alignas(64) float apfState[maxLanes]{};
+
+    alignas(64) float decay[maxLanes]{};
+    alignas(64) float output[maxLanes]{};
+};
+
+using BankLaneKernel = ResonatorLaneKernel<2 * NUM_RESONATORS>;
+using VoiceGroupLaneKernel = ResonatorLaneKernel<VOICE_GROUP_SIZE * 2 * NUM_RESONATORS>;
+
+#endif //RESONATORLANEKERNEL_H
@@ -4,6 +4,7 @@
 
 ResonatorSynth::ResonatorSynth(GlobalState& state, SynthParams params) : state(state), params(params), effectChain(params.effectChainParams)
 {
+    effectChain.profiler = &state.profiler;
     monoMSEGs.clear();
     msegData.clear();
 
@@ -27,10 +28,19 @@ void ResonatorSynth::prepare(const juce::dsp::ProcessSpec& spec)
 {
     setCurrentPlaybackSampleRate(spec.sampleRate);
 
+    //the delay line lengths depend on the sample rate, so all of their storage is handed out again from scratch
+    const juce::ScopedLock sl(resonatorMemoryLock);
+    for (auto& ready : state.resonatorMemoryReady)
+    {
+        ready.store(false, std::memory_order_release);
+    }
+    state.delayLineArena.clear();
+
     for (auto* v : voices)
     {
         dynamic_cast<ResonatorVoice*>(v)->prepare(spec);
     }
+    allocateResonatorMemory();
 
     for (auto & monoLFO : monoLFOs)
     {
@@ -50,11 +60,42 @@ void ResonatorSynth::prepare(const juce::dsp::ProcessSpec& spec)
     }
     effectChain.reset();
     effectChain.prepare(spec);
+    samplesUntilControlTick = 0;
+    governor.prepare(spec.sampleRate);
+    governor.reset(static_cast<int>(params.globalParams.numVoices->getProcValue()));
     updateParameters();
     state.modMatrix.snapParams();
 
 }
 
+void ResonatorSynth::allocateResonatorMemory()
+{
+    const juce::ScopedLock sl(resonatorMemoryLock);
+    if (getSampleRate() <= 0.0)
+        return; //not prepared yet, so the delay lines have no length
+
+    for (int b = 0; b < NUM_RESONATOR_BANKS; b++)
+    {
+        for (int r = 0; r < NUM_RESONATORS; r++)
+        {
+            auto& ready = state.resonatorMemoryReady[static_cast<size_t>(b * NUM_RESONATORS + r)];
+            if (ready.load(std::memory_order_acquire)
+                || !params.voiceParams.waveguideResonatorBankParams[b].resonatorParams[r].enabled->isOn())
+                continue;
+
+            for (auto* v : voices)
+            {
+                auto* resonator = dynamic_cast<ResonatorVoice*>(v)->resonatorBanks[b]->resonators[r];
+                for (auto& channel : resonator->resonators)
+                {
+                    channel.delayLine.setStorage(state.delayLineArena.allocate(channel.delayLine.getRequiredStorageSize()));
+                }
+            }
+            ready.store(true, std::memory_order_release);
+        }
+    }
+}
+
 void ResonatorSynth::updateParameters()
 {
     int rawIndex = static_cast<int>(params.soloResonator->getProcValue());
@@ -65,6 +106,8 @@ void ResonatorSynth::updateParameters()
         state.soloResonatorIndex = rawIndex % NUM_RESONATORS;
     }
     state.polyFX = params.globalParams.polyEffectChain->isOn();
+    state.multithreaded = params.globalParams.multithreadedVoices->isOn();
+    state.bakeResonators = params.globalParams.bakeResonators->isOn();
     for (int i = 0; i < NUM_LFOS; i++)
     {
         if (params.lfoParams[i].enabled->isOn())
@@ -139,17 +182,265 @@ void ResonatorSynth::updateParameters()
     }
 }
 
+/**
+ * Modulation and parameters are updated at a fixed control rate, on a tick every controlPeriod samples,
+ * regardless of where the host's blocks and MIDI events fall: the sub-block is rendered in chunks that end on ticks,
+ * and updated values ramp over the control period that follows. This keeps both the modulation resolution
+ * and the cost of updating parameters independent of the host's buffer size.
+ */
 void ResonatorSynth::renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
 {
-    currentBlockSize = numSamples;
-    updateParameters();
-    Synthesiser::renderNextSubBlock(outputAudio, startSample, numSamples);
-    juce::dsp::AudioBlock<float> block = juce::dsp::AudioBlock<float>(outputAudio).getSubBlock(startSample, numSamples);
+    TRACE_DSP();
+    StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::synthRender);
+    const int endSample = startSample + numSamples;
+    while (startSample < endSample)
+    {
+        const bool controlTick = samplesUntilControlTick <= 0;
+        if (controlTick)
+        {
+            controlPeriod = 1 << static_cast<int>(params.globalParams.controlPeriod->getProcValue());
+            currentBlockSize = controlPeriod;
+            updateParameters();
+            samplesUntilControlTick = controlPeriod;
+        }
+
+        const int chunkSize = juce::jmin(endSample - startSample, samplesUntilControlTick);
+        renderVoiceGroups(outputAudio, startSample, chunkSize, controlTick, samplesUntilControlTick);
+        juce::dsp::AudioBlock<float> block = juce::dsp::AudioBlock<float>(outputAudio).getSubBlock(startSample, chunkSize);
+
+        if (! state.polyFX )
+        {
+            effectChain.process(block);
+        }
+
+        samplesUntilControlTick -= chunkSize;
+        startSample += chunkSize;
+    }
+}
+
+/**
+ * Renders every active voice, in groups of up to VOICE_GROUP_SIZE voices (see VoiceGroupRenderer), each into its own buffer,
+ * then sums the voices into the output in voice order, so that the result does not depend on scheduling.
+ * When multithreading, the groups are rendered on the thread pool, and are made small enough to keep every thread busy;
+ * with fewer voices than threads, the bank chains of each voice are spread across the threads too (see renderBankChains()).
+ * Voices only touch their own state while rendering; anything that affects the synth as a whole
+ * (i.e. stopping a voice) is deferred until all voices are done.
+ */
+void ResonatorSynth::renderVoiceGroups(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples,
+                                       bool controlTick, int controlRampLength)
+{
+    const juce::ScopedLock sl(voicesLock);
 
-    if (! state.polyFX )
+    int numVoicesToRender = 0;
+    for (auto* v : voices)
+    {
+        if (v->isActive() && numVoicesToRender < static_cast<int>(voicesToRender.size()))
+        {
+            auto* voice = static_cast<ResonatorVoice*>(v);
+            voice->deferStops = true;
+            voice->controlUpdateDue = controlTick;
+            voice->controlRampLength = controlRampLength;
+            voicesToRender[static_cast<size_t>(numVoicesToRender++)] = voice;
+        }
+    }
+
+    auto* threadPool = state.threadPool.load(std::memory_order_acquire);
+    const bool parallel = state.multithreaded && threadPool != nullptr;
+    const int numThreads = parallel ? threadPool->getNumWorkers() + 1 : 1;
+    int groupSize = juce::jlimit(1, VOICE_GROUP_SIZE, (numVoicesToRender + numThreads - 1) / numThreads);
+    const int numGroups = (numVoicesToRender + groupSize - 1) / groupSize;
+
+    auto renderGroup = [this, startSample, numSamples, groupSize, numVoicesToRender](int group)
+    {
+        const int first = group * groupSize;
+        const int numVoices = juce::jmin(groupSize, numVoicesToRender - first);
+        for (int i = first; i < first + numVoices; i++)
+        {
+            voicesToRender[static_cast<size_t>(i)]->renderBuffer.clear(startSample, numSamples);
+        }
+        voiceGroupRenderers[static_cast<size_t>(group)].render(voicesToRender.data() + first, numVoices,
+                                                               startSample, numSamples);
+    };
+
+    //with fewer voices than threads, every group would hold a single voice and leave threads idle,
+    //so the independent bank chains within each voice are spread across the threads as well
+    if (parallel && numVoicesToRender < numThreads
+        && numVoicesToRender * NUM_RESONATOR_BANKS <= static_cast<int>(bankChains.size()))
+    {
+        renderBankChains(*threadPool, numVoicesToRender, startSample, numSamples);
+    }
+    else if (parallel)
+    {
+        threadPool->run(numGroups, renderGroup);
+    }
+    else
+    {
+        for (int group = 0; group < numGroups; group++)
+        {
+            renderGroup(group);
+        }
+    }
+
+    for (int i = 0; i < numVoicesToRender; i++)
+    {
+        auto* voice = voicesToRender[static_cast<size_t>(i)];
+        for (int channel = 0; channel < outputAudio.getNumChannels(); channel++)
+        {
+            outputAudio.addFrom(channel, startSample, voice->renderBuffer, channel, startSample, numSamples);
+        }
+        voice->deferStops = false;
+        voice->finishPendingStop();
+    }
+}
+
+/**
+ * Renders fewer voices than there are threads, in three rounds on the thread pool: the exciters of each voice,
+ * then every independent chain of resonator banks of every voice, then the rest of each voice (mixing, effects).
+ * Each chain still renders its coupled banks through a VoiceGroupRenderer, as a group of one voice.
+ */
+void ResonatorSynth::renderBankChains(RealtimeThreadPool& threadPool, int numVoices, int startSample, int numSamples)
+{
+    auto beginVoice = [this, startSample, numSamples](int v)
+    {
+        auto* voice = voicesToRender[static_cast<size_t>(v)];
+        StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::voiceRender);
+        voice->renderBuffer.clear(startSample, numSamples);
+        voice->beginBlock(startSample, numSamples);
+    };
+    threadPool.run(numVoices, beginVoice);
+
+    //the chains are only known once the voices have updated their parameters, in beginBlock()
+    int numChains = 0;
+    for (int v = 0; v < numVoices; v++)
+    {
+        std::array<int, NUM_RESONATOR_BANKS + 1> chainStarts;
+        const int numVoiceChains = voicesToRender[static_cast<size_t>(v)]->getBankChains(chainStarts);
+        for (int c = 0; c < numVoiceChains; c++)
+        {
+            bankChains[static_cast<size_t>(numChains++)] = {v, chainStarts[static_cast<size_t>(c)],
+                                                            chainStarts[static_cast<size_t>(c + 1)]};
+        }
+    }
+
+    auto renderChain = [this, startSample, numSamples](int c)
+    {
+        const auto& chain = bankChains[static_cast<size_t>(c)];
+        StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::voiceRender);
+        voiceGroupRenderers[static_cast<size_t>(c)].renderBanks(voicesToRender.data() + chain.voice, 1,
+                                                                chain.firstBank, chain.endBank, startSample, numSamples);
+    };
+    threadPool.run(numChains, renderChain);
+
+    auto endVoice = [this, startSample, numSamples](int v)
+    {
+        auto* voice = voicesToRender[static_cast<size_t>(v)];
+        StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::voiceRender);
+        voice->endBlock(voice->renderBuffer, startSample, numSamples);
+    };
+    threadPool.run(numVoices, endVoice);
+}
+
+void ResonatorSynth::updatePolyphony(double renderSeconds, int numSamples, bool governed)
+{
+    const juce::ScopedLock sl(voicesLock);
+    updateStealOrder();
+    cullInaudibleVoices();
+
+    int numActiveVoices = 0;
+    for (int i = 0; i < numStealableVoices; i++)
+    {
+        if (!stealOrder[static_cast<size_t>(i)]->isFadingOut()) numActiveVoices++;
+    }
+
+    const int maxVoices = static_cast<int>(params.globalParams.numVoices->getProcValue());
+    int limit = maxVoices;
+    if (governed && params.globalParams.voiceGovernor->isOn())
+    {
+        const float loadThreshold = params.globalParams.cpuLimit->getProcValue() / 100.0f;
+        limit = governor.update(renderSeconds, numSamples, numActiveVoices, maxVoices, loadThreshold);
+    }
+    else
+    {
+        governor.reset(maxVoices);
+    }
+    setNumVoices(limit);
+
+    for (int i = 0; i < numStealableVoices && numActiveVoices > limit; i++)
+    {
+        auto* voice = stealOrder[static_cast<size_t>(i)];
+        if (voice->isFadingOut()) continue;
+        voice->fadeOut();
+        numActiveVoices--;
+    }
+}
+
+/**
+ * Sorts the active voices into the order in which they should be stolen: voices that are already fading out,
+ * then released voices before held ones, quietest first. Voices that have only just started come last,
+ * since their energy has not built up yet. With at most a few dozen voices, an insertion sort after every block
+ * is cheaper than maintaining a heap as the energies change.
+ */
+void ResonatorSynth::updateStealOrder()
+{
+    auto stealsBefore = [](const ResonatorVoice* a, const ResonatorVoice* b)
+    {
+        if (a->isFadingOut() != b->isFadingOut()) return a->isFadingOut();
+        if (a->isStealProtected() != b->isStealProtected()) return b->isStealProtected();
+        if (a->noteReleased != b->noteReleased) return a->noteReleased;
+        return a->outputEnergy < b->outputEnergy;
+    };
+
+    numStealableVoices = 0;
+    for (auto* v : voices)
+    {
+        if (!v->isActive() || numStealableVoices == static_cast<int>(stealOrder.size())) continue;
+        auto* voice = static_cast<ResonatorVoice*>(v);
+        int i = numStealableVoices++;
+        while (i > 0 && stealsBefore(voice, stealOrder[static_cast<size_t>(i - 1)]))
+        {
+            stealOrder[static_cast<size_t>(i)] = stealOrder[static_cast<size_t>(i - 1)];
+            i--;
+        }
+        stealOrder[static_cast<size_t>(i)] = voice;
+    }
+}
+
+/**
+ * Fades out released voices that have decayed far below the loudest voice, where they can no longer be heard
+ * in the mix, rather than waiting for them to fall silent on their own.
+ */
+void ResonatorSynth::cullInaudibleVoices()
+{
+    float loudestEnergy = 0.0f;
+    for (int i = 0; i < numStealableVoices; i++)
+    {
+        loudestEnergy = juce::jmax(loudestEnergy, stealOrder[static_cast<size_t>(i)]->outputEnergy);
+    }
+
+    const float threshold = loudestEnergy * cullEnergyRatio;
+    for (int i = 0; i < numStealableVoices; i++)
+    {
+        auto* voice = stealOrder[static_cast<size_t>(i)];
+        if (voice->noteReleased && !voice->isFadingOut() && !voice->isStealProtected()
+            && voice->outputEnergy < threshold)
+        {
+            voice->fadeOut();
+        }
+    }
+}
+
+/**
+ * Steals the first voice in the steal order that is still playing, and has not just been started
+ * (by an earlier steal within the same block, for instance).
+ */
+juce::MPESynthesiserVoice* ResonatorSynth::findVoiceToSteal(juce::MPENote noteToStealVoiceFor) const
+{
+    for (int i = 0; i < numStealableVoices; i++)
     {
-        effectChain.process(block);
+        auto* voice = stealOrder[static_cast<size_t>(i)];
+        if (voice->isActive() && !voice->isStealProtected()) return voice;
     }
+    return gin::Synthesiser::findVoiceToSteal(noteToStealVoiceFor);
 }
 
 void ResonatorSynth::panic()
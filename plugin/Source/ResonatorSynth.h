@@ -14,6 +14,10 @@
 #include "util/RandomLFO.h"
 #include "util/StereoLFOWrapper.h"
 #include "util/StereoMSEGWrapper.h"
+#include "VoiceGroupRenderer.h"
+#include "PolyphonyGovernor.h"
+
+class ResonatorVoice;
 
 class ResonatorSynth : public gin::Synthesiser
 {
@@ -22,8 +26,33 @@ public:
     void prepare(const juce::dsp::ProcessSpec& spec);
     void updateParameters();
     void renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+    /**
+     * Renders every active voice. controlTick is whether the voices should update their parameters at startSample,
+     * and controlRampLength how many samples from startSample their updated parameters should ramp over.
+     */
+    void renderVoiceGroups(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples,
+                           bool controlTick, int controlRampLength);
+    void renderBankChains(RealtimeThreadPool& threadPool, int numVoices, int startSample, int numSamples);
     void panic();
 
+    /**
+     * Applies the voice limit after a block: the Num Voices parameter, capped by the PolyphonyGovernor from the
+     * block's render time if governed is set. Active voices above the limit are faded out, least audible first,
+     * and so are released voices that can no longer be heard (see cullInaudibleVoices()).
+     * Must be called from the audio thread, outside of rendering.
+     */
+    void updatePolyphony(double renderSeconds, int numSamples, bool governed);
+    void updateStealOrder();
+    void cullInaudibleVoices();
+    juce::MPESynthesiserVoice* findVoiceToSteal(juce::MPENote noteToStealVoiceFor) const override;
+
+    /**
+     * Hands delay line storage, out of the instance's DelayLineArena, to every voice's copy of each enabled resonator
+     * that has none yet. Memory is never given back until the next prepare(), so this is cheap once a patch has settled.
+     * Allocates, so it must never be called from the audio thread.
+     */
+    void allocateResonatorMemory();
+
     GlobalState& state;
     SynthParams params;
     ResonariumEffectChain effectChain;
@@ -33,6 +62,25 @@ public:
     juce::Array<gin::MSEG::Data> msegData;
 
     int currentBlockSize = -1;
+    int controlPeriod = 64; //in samples; modulation and parameters are updated once per control period
+    int samplesUntilControlTick = 0;
+    juce::CriticalSection resonatorMemoryLock; //serializes allocateResonatorMemory() and prepare()
+    PolyphonyGovernor governor;
+    static constexpr float cullEnergyRatio = 1.0e-6f; //released voices 60 dB below the loudest voice are culled
+
+    std::array<ResonatorVoice*, 64> stealOrder {}; //the active voices after the last block, first to be stolen first
+    int numStealableVoices = 0;
+
+    std::array<ResonatorVoice*, 64> voicesToRender {}; //the active voices of the current sub-block
+    std::array<VoiceGroupRenderer, 64> voiceGroupRenderers; //one per group of voicesToRender, or per bank chain, so that they can render concurrently
+
+    struct BankChain
+    {
+        int voice; //index into voicesToRender
+        int firstBank;
+        int endBank;
+    };
+    std::array<BankChain, 64> bankChains {}; //see renderBankChains()
 };
 
 
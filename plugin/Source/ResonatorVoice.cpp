@@ -1,10 +1,14 @@
 #include "ResonatorVoice.h"
+#include <melatonin_perfetto/melatonin_perfetto.h>
 
 ResonatorVoice::ResonatorVoice(GlobalState& state, VoiceParams params) : state(state), params(params),
+                                                                         sampleExciter(state, *this, params.sampleExciterParams),
+                                                                         externalInputExciter(state, *this, params.externalInputExciterParams),
                                                                          effectChain(params.effectChainParams)
 {
     frequency = 440.0f;
     this->disableSmoothing = true;
+    effectChain.profiler = &state.profiler;
 
     polyMSEGs.clear();
 
@@ -13,28 +17,29 @@ ResonatorVoice::ResonatorVoice(GlobalState& state, VoiceParams params) : state(s
 
     for (int i = 0; i < NUM_RESONATOR_BANKS; i++)
     {
-        auto* waveguideBank = new WaveguideResonatorBank(state, *this, params.waveguideResonatorBankParams[i]);
-        resonatorBanks.add(waveguideBank);
+        resonatorBanks.add(state, *this, params.waveguideResonatorBankParams[i]);
         dcBlockers[i].state = dcBlockerCoefficients;
     }
 
+    int numExciters = 0;
     for (int i = 0; i < NUM_IMPULSE_EXCITERS; i++)
     {
-        exciters.add(new ImpulseExciter(state, *this, params.impulseExciterParams[i]));
+        exciters[numExciters++] = impulseExciters.add(state, *this, params.impulseExciterParams[i]);
     }
 
     for (int i = 0; i < NUM_NOISE_EXCITERS; i++)
     {
-        exciters.add(new NoiseExciter(state, *this, params.noiseExciterParams[i]));
+        exciters[numExciters++] = noiseExciters.add(state, *this, params.noiseExciterParams[i]);
     }
 
     for (int i = 0; i < NUM_IMPULSE_TRAIN_EXCITERS; i++)
     {
-        exciters.add(new SequenceExciter(state, *this, params.impulseTrainExciterParams[i]));
+        exciters[numExciters++] = sequenceExciters.add(state, *this, params.impulseTrainExciterParams[i]);
     }
 
-    exciters.add(new SampleExciter(state, *this, params.sampleExciterParams));
-    exciters.add(extInExciter = new ExternalInputExciter(state, *this, params.externalInputExciterParams));
+    exciters[numExciters++] = &sampleExciter;
+    exciters[numExciters++] = extInExciter = &externalInputExciter;
+    jassert(numExciters == static_cast<int>(exciters.size()));
 
     for (int i = 0; i < NUM_LFOS; i++)
     {
@@ -62,33 +67,42 @@ ResonatorVoice::ResonatorVoice(GlobalState& state, VoiceParams params) : state(s
 
 ResonatorVoice::~ResonatorVoice()
 {
-    exciters.clear(true);
-    resonatorBanks.clear(true);
 }
 
 void ResonatorVoice::prepare(const juce::dsp::ProcessSpec& spec)
 {
     MPESynthesiserVoice::setCurrentSampleRate(spec.sampleRate);
     noteSmoother.setSampleRate(spec.sampleRate);
+    fadeOutLength = juce::jmax(1, static_cast<int>(0.005 * spec.sampleRate));
     
     // Use setSize instead of creating new buffers - more efficient when 
     // prepare() is called multiple times with the same specs
     exciterBuffer.setSize(spec.numChannels, spec.maximumBlockSize, false, true, true);
-    resonatorBankBuffer.setSize(spec.numChannels, spec.maximumBlockSize, false, true, true);
+    resonatorBankBuffer.setSize(2 * NUM_RESONATOR_BANKS, spec.maximumBlockSize, false, true, true);
     tempBuffer.setSize(spec.numChannels, spec.maximumBlockSize, false, true, true);
     soloBuffer.setSize(spec.numChannels, spec.maximumBlockSize, false, true, true);
+    renderBuffer.setSize(spec.numChannels, spec.maximumBlockSize, false, true, true);
     
     // Clear all buffers
     exciterBuffer.clear();
     resonatorBankBuffer.clear();
     tempBuffer.clear();
     soloBuffer.clear();
+    renderBuffer.clear();
 
     for (auto* exciter : exciters)
     {
         exciter->prepare(spec);
     }
 
+    //the banks read their parameters from the table from the first update on, which happens within prepare()
+    for (auto* resonatorBank : resonatorBanks)
+    {
+        resonatorBank->addModParameters(modValues);
+    }
+    modValues.prepare(spec.sampleRate, static_cast<int>(spec.maximumBlockSize));
+    modValues.update(state.modMatrix, state.modRouting, *this, static_cast<int>(spec.maximumBlockSize));
+
     for (auto* resonatorBank : resonatorBanks)
     {
         resonatorBank->prepare(spec);
@@ -125,6 +139,7 @@ void ResonatorVoice::prepare(const juce::dsp::ProcessSpec& spec)
     }
 
     effectChain.prepare(spec);
+    effectChain.reset();
 }
 
 void ResonatorVoice::noteStarted()
@@ -156,9 +171,14 @@ void ResonatorVoice::noteStarted()
     noteReleased = false;
     silenceCount = 0;
     numBlocksSinceNoteOn = 0;
+    fadingOut = false;
+    fadeOutSamplesRemaining = 0;
+    outputEnergy = 0.0f;
+    samplesSinceNoteOn = 0;
 
     snapParams();
     updateParameters(0);
+    parametersStale = true;
 
     for (auto* exciter : exciters)
     {
@@ -243,6 +263,8 @@ bool ResonatorVoice::isVoiceActive()
 
 void ResonatorVoice::updateParameters(int numSamples)
 {
+    TRACE_DSP();
+    StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::voiceParameters);
     auto note = getCurrentlyPlayingNote();
     state.modMatrix.setPolyValue(*this, state.modSrcNote, note.initialNote / 127.0f);
     currentMidiNote = noteSmoother.getCurrentValue() * 127.0f;
@@ -322,6 +344,7 @@ void ResonatorVoice::updateParameters(int numSamples)
         }
     }
 
+    modValues.update(state.modMatrix, state.modRouting, *this, numSamples);
     for (auto* resonatorBank : resonatorBanks)
     {
         resonatorBank->updateParameters(frequency, numSamples);
@@ -338,41 +361,111 @@ void ResonatorVoice::updateParameters(int numSamples)
 }
 
 void ResonatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    TRACE_DSP();
+    StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::voiceRender);
+    beginBlock(startSample, numSamples);
+    auto exciterBlock = getExciterBlock(startSample, numSamples);
+
+    if (!bypassResonators)
+    {
+        std::array<int, NUM_RESONATOR_BANKS + 1> chainStarts;
+        const int numChains = getBankChains(chainStarts);
+
+        auto renderChain = [&](int chain)
+        {
+            for (int i = chainStarts[chain]; i < chainStarts[chain + 1]; i++)
+            {
+                renderResonatorBank(i, exciterBlock, startSample, numSamples);
+            }
+        };
+
+        auto* threadPool = state.threadPool.load(std::memory_order_acquire);
+        if (state.multithreaded && threadPool != nullptr && numChains > 1)
+        {
+            threadPool->run(numChains, renderChain);
+        }
+        else
+        {
+            for (int chain = 0; chain < numChains; chain++)
+            {
+                renderChain(chain);
+            }
+        }
+    }
+
+    endBlock(outputBuffer, startSample, numSamples);
+}
+
+/**
+ * Splits the resonator banks into chains: a new chain starts at every bank that does not read the previous bank's output,
+ * so that independent chains can be rendered concurrently.
+ */
+int ResonatorVoice::getBankChains(std::array<int, NUM_RESONATOR_BANKS + 1>& chainStarts) const
+{
+    if (bypassResonators) return 0;
+    int numChains = 0;
+    for (int i = 0; i < resonatorBanks.size(); i++)
+    {
+        if (i == 0 || !resonatorBanks[i]->readsPreviousBank())
+        {
+            chainStarts[static_cast<size_t>(numChains++)] = i;
+        }
+    }
+    chainStarts[static_cast<size_t>(numChains)] = resonatorBanks.size();
+    return numChains;
+}
+
+/**
+ * The first stage of rendering a block: updates the parameters, if due, and runs the exciters.
+ * Followed by rendering the resonator banks, unless they are bypassed, and then by endBlock().
+ */
+void ResonatorVoice::beginBlock(int startSample, int numSamples)
 {
     this->currentBlockStartSample = startSample;
     this->currentBlockNumSamples = numSamples;
-    updateParameters(numSamples);
+    if (controlUpdateDue || parametersStale)
+    {
+        jassert(controlRampLength == 0 || controlRampLength >= numSamples);
+        updateParameters(controlRampLength > 0 ? controlRampLength : numSamples);
+        parametersStale = false;
+    }
+    controlUpdateDue = true;
+    controlRampLength = 0;
 
-    juce::dsp::AudioBlock<float> exciterBlock = juce::dsp::AudioBlock<float>(exciterBuffer)
-        .getSubBlock(startSample, numSamples);
+    auto exciterBlock = getExciterBlock(startSample, numSamples);
     exciterBlock.clear();
 
-    juce::dsp::AudioBlock<float> outputBlock = juce::dsp::AudioBlock<float>(outputBuffer)
-        .getSubBlock(startSample, numSamples);
-
-    juce::dsp::AudioBlock<float> previousBankBlock = juce::dsp::AudioBlock<float>(resonatorBankBuffer)
-        .getSubBlock(startSample, numSamples);
-    previousBankBlock.clear();
-
     //the output of all banks is summed into this block, which is sent to the effect chain
     juce::dsp::AudioBlock<float> tempOutputBlock = juce::dsp::AudioBlock<float>(tempBuffer)
         .getSubBlock(startSample, numSamples);
     tempOutputBlock.clear();
 
+    StageProfiler::ScopedStage stage(&state.profiler, StageProfiler::exciters);
     for (auto* exciter : exciters)
     {
         exciter->process(exciterBlock, tempOutputBlock);
     }
+}
+
+/**
+ * The last stage of rendering a block: mixes the resonator banks, applies the effect chain, solo and gain,
+ * adds the result to the output buffer, and stops the voice once it has gone silent.
+ */
+void ResonatorVoice::endBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    auto exciterBlock = getExciterBlock(startSample, numSamples);
+    juce::dsp::AudioBlock<float> outputBlock = juce::dsp::AudioBlock<float>(outputBuffer)
+        .getSubBlock(startSample, numSamples);
+    juce::dsp::AudioBlock<float> tempOutputBlock = juce::dsp::AudioBlock<float>(tempBuffer)
+        .getSubBlock(startSample, numSamples);
 
     if (!bypassResonators)
     {
+        //sum in bank order, regardless of which thread rendered which bank
         for (int i = 0; i < resonatorBanks.size(); i++)
         {
-            auto* resonatorBank = resonatorBanks[i];
-
-            resonatorBank->process(exciterBlock, previousBankBlock);
-            dcBlockers[i].process(juce::dsp::ProcessContextReplacing<float>(previousBankBlock));
-            tempOutputBlock.add(previousBankBlock);
+            tempOutputBlock.add(getResonatorBankBlock(i, startSample, numSamples));
         }
 
         if (!state.soloActive)
@@ -381,27 +474,41 @@ void ResonatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int
             {
                 effectChain.process(tempOutputBlock);
             }
-            outputBlock.add(tempOutputBlock);
+            addToOutput(tempOutputBlock, outputBlock);
         }
         else //if a solo is active, discard the full output and just send out the solo block
         {
             juce::dsp::AudioBlock<float> soloOutputBlock = juce::dsp::AudioBlock<float>(soloBuffer)
                 .getSubBlock(startSample, numSamples);
-            outputBlock.add(soloOutputBlock);
+            addToOutput(soloOutputBlock, outputBlock);
         }
     }
     else
     {
-        outputBlock.add(exciterBlock);
+        addToOutput(exciterBlock, outputBlock);
         DBG("Bypasing");
         DBG(outputBlock.findMinAndMax().getEnd());
     }
 
     outputBlock.multiplyBy(gain);
 
+    if (fadingOut && fadeOutSamplesRemaining == 0)
+    {
+        stopFromRender();
+        finishBlock(numSamples);
+        return;
+    }
+
     //Silence detection code
+    //once every resonator bank has gone to sleep, only the effect chain can still be ringing, so test every block
+    bool resonatorsSleeping = !bypassResonators;
+    for (auto* resonatorBank : resonatorBanks)
+    {
+        resonatorsSleeping = resonatorsSleeping && resonatorBank->sleeping;
+    }
     testForSilenceBlockCount++;
-    if (testForSilenceBlockCount > testForSilenceBlockPeriod && noteReleased && numBlocksSinceNoteOn > 10)
+    if ((testForSilenceBlockCount > testForSilenceBlockPeriod || resonatorsSleeping)
+        && noteReleased && numBlocksSinceNoteOn > 10)
     {
         testForSilenceBlockCount = 0;
         float maxAmplitude = outputBuffer.getMagnitude(startSample, numSamples);
@@ -411,15 +518,13 @@ void ResonatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int
             if (silenceCount > silenceCountThreshold)
             {
                 DBG("Silence detected, stopping note " + juce::String(id));
-                stopVoice();
-                clearCurrentNote();
+                stopFromRender();
             }
         }
         else if (maxAmplitude > 100.0f)
         {
             DBG("Amplitude overflow detected in silence detection code, stopping note " + juce::String(id));
-            stopVoice();
-            clearCurrentNote();
+            stopFromRender();
         }
         else
         {
@@ -431,6 +536,123 @@ void ResonatorVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int
     finishBlock(numSamples);
 }
 
+juce::dsp::AudioBlock<float> ResonatorVoice::getResonatorBankBlock(int bankIndex, int startSample, int numSamples)
+{
+    return juce::dsp::AudioBlock<float>(resonatorBankBuffer.getArrayOfWritePointers() + 2 * bankIndex, 2,
+                                        static_cast<size_t>(startSample), static_cast<size_t>(numSamples));
+}
+
+/**
+ * Renders a single resonator bank into its own block.
+ * A bank that reads the previous bank starts from a copy of the previous bank's output; any other bank starts from silence.
+ */
+void ResonatorVoice::renderResonatorBank(int bankIndex, juce::dsp::AudioBlock<float>& exciterBlock,
+                                         int startSample, int numSamples)
+{
+    auto bankBlock = beginResonatorBank(bankIndex, startSample, numSamples);
+    resonatorBanks[bankIndex]->process(exciterBlock, bankBlock);
+    finishResonatorBank(bankIndex, bankBlock);
+}
+
+juce::dsp::AudioBlock<float> ResonatorVoice::getExciterBlock(int startSample, int numSamples)
+{
+    return juce::dsp::AudioBlock<float>(exciterBuffer).getSubBlock(static_cast<size_t>(startSample),
+                                                                   static_cast<size_t>(numSamples));
+}
+
+/**
+ * Returns the block that a resonator bank processes in place: a copy of the previous bank's output
+ * if the bank reads the previous bank, or silence otherwise.
+ */
+juce::dsp::AudioBlock<float> ResonatorVoice::beginResonatorBank(int bankIndex, int startSample, int numSamples)
+{
+    auto bankBlock = getResonatorBankBlock(bankIndex, startSample, numSamples);
+    if (bankIndex > 0 && resonatorBanks[bankIndex]->readsPreviousBank())
+    {
+        bankBlock.copyFrom(getResonatorBankBlock(bankIndex - 1, startSample, numSamples));
+    }
+    else
+    {
+        bankBlock.clear();
+    }
+    return bankBlock;
+}
+
+void ResonatorVoice::finishResonatorBank(int bankIndex, juce::dsp::AudioBlock<float>& bankBlock)
+{
+    dcBlockers[bankIndex].process(juce::dsp::ProcessContextReplacing<float>(bankBlock));
+}
+
+/**
+ * Adds the voice's output to the output block, fading it out if the voice is being stolen,
+ * and keeps track of its energy.
+ */
+void ResonatorVoice::addToOutput(juce::dsp::AudioBlock<float>& voiceBlock, juce::dsp::AudioBlock<float>& outputBlock)
+{
+    if (fadingOut)
+    {
+        const int numSamples = static_cast<int>(voiceBlock.getNumSamples());
+        const int numFading = juce::jmin(numSamples, fadeOutSamplesRemaining);
+        for (size_t c = 0; c < voiceBlock.getNumChannels(); c++)
+        {
+            float* samples = voiceBlock.getChannelPointer(c);
+            for (int i = 0; i < numFading; i++)
+            {
+                samples[i] *= static_cast<float>(fadeOutSamplesRemaining - i) / static_cast<float>(fadeOutLength);
+            }
+            juce::FloatVectorOperations::clear(samples + numFading, numSamples - numFading);
+        }
+        fadeOutSamplesRemaining -= numFading;
+    }
+
+    //the running mean square of both channels, smoothed one block at a time
+    const int numSamples = static_cast<int>(voiceBlock.getNumSamples());
+    float sumOfSquares = 0.0f;
+    for (size_t c = 0; c < voiceBlock.getNumChannels(); c++)
+    {
+        const float* samples = voiceBlock.getChannelPointer(c);
+        for (int i = 0; i < numSamples; i++)
+        {
+            sumOfSquares += samples[i] * samples[i];
+        }
+    }
+    const float meanSquare = numSamples > 0
+        ? sumOfSquares * gain * gain / static_cast<float>(numSamples * static_cast<int>(voiceBlock.getNumChannels()))
+        : 0.0f;
+    const auto smoothing = static_cast<float>(std::exp(-numSamples / (energyTimeConstant * getSampleRate())));
+    outputEnergy = meanSquare + smoothing * (outputEnergy - meanSquare);
+    //saturated once the voice is no longer protected, so that a held note never overflows it
+    samplesSinceNoteOn = juce::jmin(samplesSinceNoteOn + numSamples,
+                                    static_cast<int>(std::ceil(stealProtectionTime * getSampleRate())));
+    outputBlock.add(voiceBlock);
+}
+
+void ResonatorVoice::fadeOut()
+{
+    if (fadingOut) return;
+    fadingOut = true;
+    fadeOutSamplesRemaining = fadeOutLength;
+}
+
+void ResonatorVoice::stopFromRender()
+{
+    if (deferStops)
+    {
+        stopPending = true;
+        return;
+    }
+    stopVoice();
+    clearCurrentNote();
+}
+
+void ResonatorVoice::finishPendingStop()
+{
+    if (!stopPending) return;
+    stopPending = false;
+    stopVoice();
+    clearCurrentNote();
+}
+
 void ResonatorVoice::notePressureChanged()
 {
     auto note = getCurrentlyPlayingNote();
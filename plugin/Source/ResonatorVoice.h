@@ -9,6 +9,8 @@
 #include "util/RandomLFO.h"
 #include "util/StereoLFOWrapper.h"
 #include "util/StereoMSEGWrapper.h"
+#include "util/InlineArray.h"
+#include "util/ModValueTable.h"
 #include "util/WrappedEnvelope.h"
 
 class ResonariumProcessor;
@@ -31,14 +33,44 @@ public:
     void updateParameters(int numSamples);
     void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
     bool isVoiceActive() override;
+    /**
+     * Stops the voice from within renderNextBlock(). While deferStops is set (i.e. while voices render on worker threads),
+     * the stop is only recorded, and must be carried out by the audio thread via finishPendingStop().
+     */
+    void stopFromRender();
+    void finishPendingStop();
+    /**
+     * Fades the voice out over fadeOutLength samples, then stops it, so that a stolen voice does not click.
+     */
+    void fadeOut();
+    bool isFadingOut() const { return fadingOut; }
+    bool isStealProtected() const { return samplesSinceNoteOn < stealProtectionTime * getSampleRate(); }
+    juce::dsp::AudioBlock<float> getResonatorBankBlock(int bankIndex, int startSample, int numSamples);
+    void renderResonatorBank(int bankIndex, juce::dsp::AudioBlock<float>& exciterBlock, int startSample, int numSamples);
+    /**
+     * Fills chainStarts with the first bank of each chain of banks that only depend on each other, followed by the number
+     * of banks, and returns the number of chains (none if the resonators are bypassed). Only valid once the block has begun.
+     */
+    int getBankChains(std::array<int, NUM_RESONATOR_BANKS + 1>& chainStarts) const;
+
+    //renderNextBlock() in stages, so that the VoiceGroupRenderer can render the banks of several voices together:
+    //beginBlock(), then beginResonatorBank(), WaveguideResonatorBank::process() and finishResonatorBank() for each bank
+    //in order (unless bypassResonators is set), then endBlock()
+    void beginBlock(int startSample, int numSamples);
+    void endBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+    juce::dsp::AudioBlock<float> getExciterBlock(int startSample, int numSamples);
+    juce::dsp::AudioBlock<float> beginResonatorBank(int bankIndex, int startSample, int numSamples);
+    void finishResonatorBank(int bankIndex, juce::dsp::AudioBlock<float>& bankBlock);
+    void addToOutput(juce::dsp::AudioBlock<float>& voiceBlock, juce::dsp::AudioBlock<float>& outputBlock);
 
     GlobalState& state;
     VoiceParams params;
+    ModValueTable modValues; //the modulated values of the resonator banks' parameters, refreshed in updateParameters()
     float frequency = 440.0f;
     gin::EasedValueSmoother<float> noteSmoother;
     float currentMidiNote = 64;
     int id = 0;
-    juce::OwnedArray<WaveguideResonatorBank> resonatorBanks;
+    InlineArray<WaveguideResonatorBank, NUM_RESONATOR_BANKS> resonatorBanks; //constructed in place, inside the voice
     float gain = 1.0f;
 
     int currentBlockStartSample = 0; //start sample of the current block
@@ -53,13 +85,38 @@ public:
     int testForSilenceBlockCount = 0;
 
     juce::AudioBuffer<float> exciterBuffer; // buffer for exciters to write to, is routed to resonator banks
-    juce::AudioBuffer<float> resonatorBankBuffer; // buffer for resonator banks to write to, is routed to output
+    juce::AudioBuffer<float> resonatorBankBuffer; // one stereo pair of channels per resonator bank for the banks to write to, is routed to output
     juce::AudioBuffer<float> tempBuffer; // temporary buffer for processing
     juce::AudioBuffer<float> soloBuffer; // if a resonator's solo button is toggled, that resonator's output is routed here
+    juce::AudioBuffer<float> renderBuffer; // when voices render in parallel, each voice renders into its own buffer
+
+    bool deferStops = false;
+    bool stopPending = false;
+
+    static constexpr double energyTimeConstant = 0.05; //seconds
+    static constexpr double stealProtectionTime = 0.03; //seconds after note on during which the voice is only stolen as a last resort
+    float outputEnergy = 0.0f; //the running mean square of the voice's output, used to pick voices to steal and cull
+    int samplesSinceNoteOn = 0; //up to stealProtectionTime's worth
+    bool fadingOut = false;
+    int fadeOutLength = 256; //in samples, about 5 ms; set in prepare()
+    int fadeOutSamplesRemaining = 0;
+
+    //set by the synth before each block: whether this block starts on a control tick, i.e. should update the parameters,
+    //and how many samples the updated parameters should ramp over (see ResonatorSynth::renderNextSubBlock()).
+    //Both are reset after every block, so a voice that is rendered directly updates its parameters on every block.
+    bool controlUpdateDue = true;
+    int controlRampLength = 0; //0 means the length of the block
+    bool parametersStale = true; //set when a note starts, so that the next block updates the parameters regardless
 
     juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> dcBlockers[NUM_RESONATORS];
 
-    juce::OwnedArray<Exciter> exciters;
+    //the exciters live inside the voice too; exciters lists them all, in the order they are processed
+    InlineArray<ImpulseExciter, NUM_IMPULSE_EXCITERS> impulseExciters;
+    InlineArray<NoiseExciter, NUM_NOISE_EXCITERS> noiseExciters;
+    InlineArray<SequenceExciter, NUM_IMPULSE_TRAIN_EXCITERS> sequenceExciters;
+    SampleExciter sampleExciter;
+    ExternalInputExciter externalInputExciter;
+    std::array<Exciter*, NUM_IMPULSE_EXCITERS + NUM_NOISE_EXCITERS + NUM_IMPULSE_TRAIN_EXCITERS + 2> exciters;
     ExternalInputExciter* extInExciter; //alias for the external input exciter which requires some special treatment
 
     std::array<StereoLFOWrapper, NUM_LFOS> polyLFOs;
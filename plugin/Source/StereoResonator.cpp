@@ -22,8 +22,8 @@ float StereoResonator::Resonator::popSample()
     }
     auto delay = delayLengthInterpolator.nextValue();
     delayLine.setDelay(delay);
-    float outSample = delayLine.popSample(0);
-    outSample = loopFilter.processSample(0, outSample);
+    float outSample = delayLine.popSample();
+    outSample = loopFilter.processSample(outSample);
     outSample = apf.processSample(outSample);
     jassert(!std::isnan(outSample * decayCoefficient));
     return outSample * decayCoefficient;
@@ -37,10 +37,87 @@ void StereoResonator::Resonator::pushSample(float input)
         passthroughSample = input;
         return;
     }
-    delayLine.pushSample(0, input);
+    delayLine.pushSample(input);
     jassert(!std::isnan(input));
 }
 
+bool StereoResonator::Resonator::canProcessBlock(int numSamples) const
+{
+    const float minDelay = juce::jmin(delayLengthInterpolator.getCurrentValue(), delayLengthInterpolator.getTargetValue());
+    return ResonatorDelayLine::canReadBlock(minDelay, numSamples);
+}
+
+void StereoResonator::Resonator::processBlock(const float* in, float* out, int numSamples)
+{
+    if (passthrough)
+    {
+        juce::FloatVectorOperations::copy(out, in, numSamples);
+        return;
+    }
+
+    if (!canProcessBlock(numSamples))
+    {
+        for (int i = 0; i < numSamples; i++)
+        {
+            out[i] = processSample(in[i]);
+        }
+        return;
+    }
+
+    if (delayLengthInterpolator.isStatic())
+    {
+        delayLine.setDelay(delayLengthInterpolator.nextValue());
+        delayLine.popBlock(out, numSamples);
+    }
+    else
+    {
+        //the delay trajectory is written into the output block, which is then overwritten by the read
+        for (int i = 0; i < numSamples; i++)
+        {
+            out[i] = delayLengthInterpolator.nextValue();
+        }
+        delayLine.popBlock(out, out, numSamples);
+    }
+
+    loopFilter.processBlock(out, numSamples);
+    apf.processBlock(out, numSamples);
+    juce::FloatVectorOperations::multiply(out, decayCoefficient, numSamples);
+    delayLine.pushBlock(in, out, numSamples);
+}
+
+void StereoResonator::Resonator::updateActivity(int numSamples)
+{
+    if (passthrough || sleeping) return;
+
+    //the last numSamples pushed samples are contiguous, starting just after the read pointer
+    const int n = juce::jmin(numSamples, delayLine.getTotalSize());
+    const float* pushed = delayLine.getReadPointer() + 1;
+    float sumOfSquares = 0.0f;
+    for (int i = 0; i < n; i++)
+    {
+        sumOfSquares += pushed[i] * pushed[i];
+    }
+    meanSquare = n > 0 ? sumOfSquares / static_cast<float>(n) : 0.0f;
+
+    if (meanSquare < silenceThreshold * silenceThreshold)
+    {
+        quietSamples = juce::jmin(quietSamples + numSamples, std::numeric_limits<int>::max() / 2);
+    }
+    else
+    {
+        quietSamples = 0;
+    }
+}
+
+bool StereoResonator::Resonator::isQuiet() const
+{
+    if (passthrough || sleeping) return true;
+    //only the part of the delay line that is actually read back has to be quiet, plus the interpolator's extra taps;
+    //while the length glides, the longer of the two lengths is the one that reaches furthest back
+    const float delayLength = juce::jmax(delayLengthInSamples, delayLengthInterpolator.getCurrentValue());
+    return quietSamples >= static_cast<int>(std::ceil(delayLength)) + 3;
+}
+
 float StereoResonator::Resonator::postProcess(float input)
 {
     const float sample = postFilter.processSample(0, input);
@@ -51,16 +128,20 @@ float StereoResonator::Resonator::postProcess(float input)
 void StereoResonator::Resonator::reset()
 {
     delayLengthInterpolator.snapValue(delayLengthInSamples);
-    delayLine.reset();
+    meanSquare = 0.0f;
+    quietSamples = 0;
+    sleeping = false;
     loopFilter.reset();
+    loopFilterPrototype.reset();
     postFilter.reset();
     apf.reset();
-#if JUCE_DEBUG
-    auto readSpan = delayLine.getRawDelayBuffer().getReadSpan(0);
-    for (auto sample : readSpan)
+    //only the samples that the next reads can reach are actually zeroed, in updateParameters(), so that a note-on
+    //does not cost a memset of the whole delay line; storage that has not been handed out yet arrives zeroed anyway
+    if (hasDelayLineStorage())
     {
-        jassert(sample == 0.0f);
+        delayLine.clearLazily();
     }
+#if JUCE_DEBUG
     if (delayLengthInSamples < 0)
     {
         //reset called before prepare and update
@@ -75,9 +156,34 @@ void StereoResonator::Resonator::prepare(const juce::dsp::ProcessSpec& spec)
 {
     this->sampleRate = spec.sampleRate;
     loopFilter.prepare({spec.sampleRate, spec.maximumBlockSize, 1});
+    loopFilterPrototype.prepare({spec.sampleRate, spec.maximumBlockSize, 1});
     postFilter.prepare({spec.sampleRate, spec.maximumBlockSize, 1});
+    postFilterDirty = true;
     apf.prepare(spec);
-    delayLine.prepare(spec);
+    //the storage itself is handed out afterwards by the synth, for enabled resonators only
+    delayLine.setMaximumDelayInSamples(static_cast<int>(std::ceil(sampleRate / MIN_RESONATOR_FREQUENCY)));
+}
+
+void StereoResonator::Resonator::addModParameters(ModValueTable& table)
+{
+    modHandles.gain = table.addParameter(params.gain);
+    modHandles.pitch = table.addParameter(params.pitch);
+    modHandles.frequency = table.addParameter(params.frequency);
+    modHandles.decayTime = table.addParameter(params.decayTime);
+    modHandles.dispersion = table.addParameter(params.dispersion);
+    modHandles.loopFilterCutoff = table.addParameter(params.loopFilterCutoff);
+    modHandles.loopFilterPitchInSemis = table.addParameter(params.loopFilterPitchInSemis);
+    modHandles.loopFilterResonance = table.addParameter(params.loopFilterResonance);
+    modHandles.postFilterCutoff = table.addParameter(params.postFilterCutoff);
+    modHandles.postFilterPitchInSemis = table.addParameter(params.postFilterPitchInSemis);
+    modHandles.postFilterResonance = table.addParameter(params.postFilterResonance);
+    modHandles.postFilterMode = table.addParameter(params.postFilterMode);
+}
+
+bool StereoResonator::Resonator::hasDelayLineStorage() const
+{
+    return voice.state.resonatorMemoryReady[static_cast<size_t>(params.bankIndex * NUM_RESONATORS + params.resonatorIndex)]
+        .load(std::memory_order_acquire);
 }
 
 //This function is the worst. It always ends up being the worst. Just a mess.
@@ -85,56 +191,91 @@ void StereoResonator::Resonator::prepare(const juce::dsp::ProcessSpec& spec)
 //"Let it not be the worst this time," I proclaimed.
 //But now it's the worst again. Somehow.
 //TODO Study why this keeps happening to me.
-void StereoResonator::Resonator::updateParameters(float frequency, int numSamples)
+void StereoResonator::Resonator::beginUpdate(float frequency, ResonatorCoefficientBatch& batch)
 {
-    this->gain = voice.getValue(params.gain);
+    coefficientLane = batch.addLane();
+    const int l = coefficientLane;
 
+    batch.voiceFrequency[l] = frequency;
     postFilterKeytrack = params.postFilterKeytrack->isOn();
-    const float newPostFilterCutoff = postFilterKeytrack
-                                          ? frequency * std::pow(
-                                              2.0f, voice.getValue(params.postFilterPitchInSemis, channel) / 12.0f)
-                                          : voice.getValue(params.postFilterCutoff, channel);
-    const float newPostFilterResonance = voice.getValue(params.postFilterResonance, channel);
-    const float newPostFilterMode = voice.getValue(params.postFilterMode, channel);
-    postFilter.updateParameters(newPostFilterCutoff, newPostFilterResonance, newPostFilterMode);
-    const float decayInSeconds = voice.getValue(params.decayTime, channel);
+    batch.postFilterKeytrack[l] = postFilterKeytrack ? 1.0f : 0.0f;
+    if (postFilterKeytrack)
+    {
+        batch.postFilterSemitones[l] = voice.modValues.get(modHandles.postFilterPitchInSemis, channel);
+    }
+    else
+    {
+        batch.postFilterCutoff[l] = voice.modValues.get(modHandles.postFilterCutoff, channel);
+    }
 
+    const float decayInSeconds = voice.modValues.get(modHandles.decayTime, channel);
     if (decayInSeconds < 0.03f)
     {
         passthrough = true;
         return;
     }
     passthrough = false;
-    passthroughSample = 0;
     lastFrequency = nextFrequency;
     keytrack = params.resonatorKeytrack->isOn();
     if (keytrack)
     {
-        nextFrequency = voice.getValue(params.pitch) * frequency;
+        nextFrequency = voice.modValues.get(modHandles.pitch) * frequency;
     }
     else
     {
-        nextFrequency = voice.getValue(params.frequency, channel);
+        nextFrequency = voice.modValues.get(modHandles.frequency, channel);
     }
+    nextFrequency = juce::jmax(nextFrequency, MIN_RESONATOR_FREQUENCY);
+    batch.resonatorFrequency[l] = nextFrequency;
+    batch.decayInSeconds[l] = decayInSeconds;
 
-    if (decayInSeconds == 60.0f)
+    loopFilterKeytrack = params.loopFilterKeytrack->isOn();
+    batch.loopFilterKeytrack[l] = loopFilterKeytrack ? 1.0f : 0.0f;
+    if (loopFilterKeytrack)
     {
-        decayCoefficient = 1.0f;
+        batch.loopFilterSemitones[l] = voice.modValues.get(modHandles.loopFilterPitchInSemis, channel);
     }
     else
     {
-        decayCoefficient = std::pow(0.001f, 1.0f / (decayInSeconds * nextFrequency));
+        batch.loopFilterCutoff[l] = voice.modValues.get(modHandles.loopFilterCutoff, channel);
     }
 
-    loopFilterKeytrack = params.loopFilterKeytrack->isOn();
-    const float newCutoff = loopFilterKeytrack
-                                ? nextFrequency * std::pow(
-                                    2.0f, voice.getValue(params.loopFilterPitchInSemis, channel) / 12.0f)
-                                : voice.getValue(params.loopFilterCutoff, channel);
-    const float newResonance = voice.getValue(params.loopFilterResonance, channel) + 0.001f;
+    dispersion = voice.modValues.get(modHandles.dispersion, channel);
+    batch.dispersion[l] = dispersion;
+}
+
+void StereoResonator::Resonator::finishUpdate(const ResonatorCoefficientBatch& batch, int numSamples)
+{
+    const int l = coefficientLane;
+    this->gain = voice.modValues.get(modHandles.gain);
+
+    const float newPostFilterCutoff = batch.postFilterCutoffOut[l];
+    const float newPostFilterResonance = voice.modValues.get(modHandles.postFilterResonance, channel);
+    const float newPostFilterMode = voice.modValues.get(modHandles.postFilterMode, channel);
+    if (postFilterDirty || newPostFilterCutoff != postFilterCutoff || newPostFilterResonance != postFilterResonance
+        || newPostFilterMode != postFilterMode)
+    {
+        postFilterCutoff = newPostFilterCutoff;
+        postFilterResonance = newPostFilterResonance;
+        postFilterMode = newPostFilterMode;
+        postFilter.updateParameters(postFilterCutoff, postFilterResonance, postFilterMode);
+        postFilterDirty = false;
+    }
+
+    if (passthrough)
+    {
+        return;
+    }
+    passthroughSample = 0;
+
+    decayCoefficient = batch.decayInSeconds[l] == 60.0f ? 1.0f : batch.decayCoefficientOut[l];
+
+    const float newCutoff = batch.loopFilterCutoffOut[l];
+    const float newResonance = voice.modValues.get(modHandles.loopFilterResonance, channel) + 0.001f;
     const float newMode = params.loopFilterType->getProcValue() * 0.5f;
     jassert(newMode == 0 || newMode == 0.5 || newMode == 1);
-    bool updated = loopFilter.updateParameters(newCutoff, newResonance, newMode, loopFilterKeytrack);
+    loopFilter.setParameters(newCutoff, newResonance, newMode, batch.loopFilterPrewarpOut[l]);
+    bool updated = loopFilterPrototype.updateParameters(newCutoff, newResonance, newMode, loopFilterKeytrack);
     if (updated)
     {
         if(newMode == 0.5)
@@ -142,13 +283,11 @@ void StereoResonator::Resonator::updateParameters(float frequency, int numSample
             loopFilterPhaseDelay = 0;
         } else
         {
-            loopFilterPhaseDelay = loopFilter.getPhaseDelayInSamples(nextFrequency);
+            loopFilterPhaseDelay = loopFilterPrototype.getPhaseDelayInSamples(nextFrequency);
         }
     }
 
-    float newDispersion = voice.getValue(params.dispersion, channel);
-    dispersion = newDispersion;
-    apf.setDispersionAmount(newDispersion);
+    apf.setCoefficients(batch.dispersionCosOut[l], batch.dispersionSinOut[l]);
 
     //experimentally, the delay line Lagrange interpolation adds a delay of one sample plus change.
     //this tuning error, if unaddressed, is readily observed at higher frequencies.
@@ -163,6 +302,7 @@ void StereoResonator::Resonator::updateParameters(float frequency, int numSample
     }
     delayLengthInterpolator.setTargetValue(delayLengthInSamples, numSamples);
     delayLine.setDelay(delayLengthInSamples);
+    delayLine.makeReadable(juce::jmax(delayLengthInterpolator.getCurrentValue(), delayLengthInSamples));
 
 #if JUCE_SNAP_TO_ZERO
     postFilter.snapToZero();
@@ -170,6 +310,45 @@ void StereoResonator::Resonator::updateParameters(float frequency, int numSample
 #endif
 }
 
+void StereoResonator::Resonator::keepParameters(int numSamples)
+{
+    delayLengthInterpolator.setTargetValue(delayLengthInterpolator.getTargetValue(), numSamples);
+}
+
+bool StereoResonator::Resonator::hasSameParametersAs(const Resonator& other) const
+{
+    return passthrough == other.passthrough
+        && gain == other.gain
+        && decayCoefficient == other.decayCoefficient
+        && delayLengthInSamples == other.delayLengthInSamples
+        && dispersion == other.dispersion
+        && loopFilter.cutoff == other.loopFilter.cutoff
+        && loopFilter.q == other.loopFilter.q
+        && loopFilter.mode == other.loopFilter.mode
+        && postFilterCutoff == other.postFilterCutoff
+        && postFilterResonance == other.postFilterResonance
+        && postFilterMode == other.postFilterMode;
+}
+
+void StereoResonator::Resonator::copyStateFrom(const Resonator& other)
+{
+    //only where the delay length is now; it keeps gliding to this channel's own target, set by finishUpdate()
+    delayLengthInterpolator.setCurrentValue(other.delayLengthInterpolator.getCurrentValue());
+    delayLine.copyStateFrom(other.delayLine);
+    delayLine.makeReadable(juce::jmax(delayLengthInterpolator.getCurrentValue(), delayLengthInSamples));
+    loopFilter.ic1eq = other.loopFilter.ic1eq;
+    loopFilter.ic2eq = other.loopFilter.ic2eq;
+    apf.state[0] = other.apf.state[0];
+    apf.state[1] = other.apf.state[1];
+    //the post filter's state is not exposed, so it is copied whole, then given back this channel's parameters
+    postFilter = other.postFilter;
+    postFilter.updateParameters(postFilterCutoff, postFilterResonance, postFilterMode);
+    passthroughSample = other.passthroughSample;
+    meanSquare = other.meanSquare;
+    quietSamples = other.quietSamples;
+    sleeping = other.sleeping;
+}
+
 float StereoResonator::processSample(const float input, const int channel)
 {
     jassert(channel == 0 || channel == 1);
@@ -191,6 +370,17 @@ void StereoResonator::pushSample(float input, int channel)
     resonators[channel].pushSample(input);
 }
 
+void StereoResonator::processBlock(const float* in, float* out, int numSamples, int channel)
+{
+    jassert(channel == 0 || channel == 1);
+    if (!enabled)
+    {
+        juce::FloatVectorOperations::clear(out, numSamples);
+        return;
+    }
+    resonators[channel].processBlock(in, out, numSamples);
+}
+
 float StereoResonator::postProcess(float sample, int channel)
 {
     jassert(channel == 0 || channel == 1);
@@ -202,26 +392,99 @@ void StereoResonator::reset()
 {
     resonators[0].reset();
     resonators[1].reset();
+    collapsed = true;
+    parametersDirty = true; //the delay line has to be made readable again
+}
+
+bool StereoResonator::updateCollapse(bool inputsIdentical)
+{
+    if (collapsed && !(inputsIdentical && left.hasSameParametersAs(right)))
+    {
+        right.copyStateFrom(left);
+        collapsed = false;
+    }
+    return collapsed;
+}
+
+void StereoResonator::addModParameters(ModValueTable& table)
+{
+    resonators[0].addModParameters(table);
+    resonators[1].addModParameters(table);
 }
 
 void StereoResonator::prepare(const juce::dsp::ProcessSpec& spec)
 {
     resonators[0].prepare(spec);
     resonators[1].prepare(spec);
+    //the smoothers only advance at the end of each block, so the values read can lag by a block more
+    settlingSamples = static_cast<int>(std::ceil(PARAMETER_SMOOTHING_TIME * spec.sampleRate))
+        + static_cast<int>(spec.maximumBlockSize);
     updateParameters(440.0f, spec.maximumBlockSize, true);
 }
 
 void StereoResonator::updateParameters(float frequency, int numSamples, bool force)
 {
-    this->enabled = params.enabled->isOn();
+    ResonatorCoefficientBatch batch;
+    beginUpdate(frequency, numSamples, batch, force);
+    batch.compute(left.sampleRate);
+    finishUpdate(batch, numSamples);
+}
+
+void StereoResonator::beginUpdate(float frequency, int numSamples, ResonatorCoefficientBatch& batch, bool force)
+{
+    updatePending = false;
+    //a resonator that was only just enabled stays silent until its delay line storage has been allocated
+    this->enabled = params.enabled->isOn() && resonators[0].hasDelayLineStorage();
     if (this->enabled || force)
     {
-        resonators[0].updateParameters(frequency, numSamples);
-        resonators[1].updateParameters(frequency, numSamples);
+        const bool changed = parametersChanged();
+        if (changed) samplesSinceChange = 0;
+        const bool settling = samplesSinceChange >= 0;
+        if (settling)
+        {
+            //the update that runs once the smoothing is over reads the final values, and is the last one
+            samplesSinceChange = samplesSinceChange >= settlingSamples ? -1 : samplesSinceChange + numSamples;
+        }
+        if (!force && !parametersDirty && !settling && frequency == lastVoiceFrequency)
+        {
+            resonators[0].keepParameters(numSamples);
+            resonators[1].keepParameters(numSamples);
+            return;
+        }
+
+        resonators[0].beginUpdate(frequency, batch);
+        resonators[1].beginUpdate(frequency, batch);
+        lastVoiceFrequency = frequency;
+        parametersDirty = false;
+        updatePending = true;
     }
     else
     {
         resonators[0].gain = 0;
         resonators[1].gain = 0;
+        parametersDirty = true;
+    }
+}
+
+void StereoResonator::finishUpdate(const ResonatorCoefficientBatch& batch, int numSamples)
+{
+    if (!updatePending) return;
+    resonators[0].finishUpdate(batch, numSamples);
+    resonators[1].finishUpdate(batch, numSamples);
+    updatePending = false;
+}
+
+bool StereoResonator::parametersChanged()
+{
+    //values computed under modulation are stale as soon as the modulation is removed, so the update after it runs too
+    bool changed = modulated;
+    modulated = false;
+    for (size_t i = 0; i < trackedParameters.size(); i++)
+    {
+        const float value = trackedParameters[i]->getValue();
+        changed = changed || value != lastParameterValues[i];
+        lastParameterValues[i] = value;
+        modulated = modulated || voice.state.modMatrix.isModulated(gin::ModDstId(trackedParameters[i]->getModIndex()));
     }
+    return changed || modulated;
 }
@@ -3,7 +3,10 @@
 
 #include "Parameters.h"
 #include "dsp/Filters.h"
+#include "dsp/ResonatorDelayLine.h"
+#include "ResonatorCoefficientBatch.h"
 #include "util/InterpolatedValue.h"
+#include "util/ModValueTable.h"
 #include <chowdsp_filters/chowdsp_filters.h>
 #include <chowdsp_dsp_utils/chowdsp_dsp_utils.h>
 
@@ -11,6 +14,7 @@ class ResonatorVoice;
 
 class StereoResonator
 {
+public:
     class Resonator
     {
     public:
@@ -22,8 +26,8 @@ class StereoResonator
             HPF = 2,
         };
 
-        Resonator(ResonatorVoice& voice, ResonatorParams params, int channel) : voice(voice), params(params),
-                                                                               channel(channel), delayLine(21000)
+        Resonator(ResonatorVoice& voice, const ResonatorParams& params, int channel) : voice(voice), params(params),
+                                                                                      channel(channel)
         {
             jassert(channel == 0 || channel == 1);
         }
@@ -46,58 +50,173 @@ class StereoResonator
          */
         void pushSample(float input);
 
+        /**
+         * Processes a whole block through the resonator; the block equivalent of calling processSample() on every sample.
+         * When the delay line is longer than the block, nothing that is read during the block is also written during it,
+         * so the delay-line read, loop filter and allpass each run over the whole block in one pass.
+         * Otherwise, falls back to per-sample processing.
+         * in and out must not overlap.
+         */
+        void processBlock(const float* in, float* out, int numSamples);
+
+        /**
+         * Whether processBlock() can process a block of numSamples in one pass,
+         * i.e. whether the delay length stays above the block size for the whole block.
+         */
+        bool canProcessBlock(int numSamples) const;
+
         float postProcess(float sample);
 
+        /**
+         * Measures the energy that was pushed into the delay line over the last numSamples samples
+         * (loop output plus input), and counts how long the delay line has been quiet.
+         * Call once after each block.
+         */
+        void updateActivity(int numSamples);
+
+        /**
+         * A resonator is quiet once everything in its delay line is below the silence threshold,
+         * i.e. once it has been quiet for at least the current delay length, which is all that is ever read back.
+         * A quiet resonator can be put to sleep and skipped entirely until it receives input again.
+         */
+        bool isQuiet() const;
+        void sleep() { sleeping = true; }
+        void wake()
+        {
+            sleeping = false;
+            quietSamples = 0;
+        }
+
+        /**
+         * Whether the delay line has been given its storage. Delay line memory is only allocated for enabled resonators,
+         * off the audio thread (see ResonatorSynth::allocateResonatorMemory()); until it lands, the delay line must not be touched.
+         */
+        bool hasDelayLineStorage() const;
+
+        /**
+         * Adds the parameters that beginUpdate() and finishUpdate() read to the voice's ModValueTable.
+         * Must be called before the first update.
+         */
+        void addModParameters(ModValueTable& table);
+
         void reset();
         void prepare(const juce::dsp::ProcessSpec& spec);
-        void updateParameters(float frequency, int numSamples);
+        /**
+         * Updates the parameters in two stages, so that the coefficients of many resonators can be computed together:
+         * beginUpdate() reads the parameters and adds a lane with the coefficient inputs to the batch,
+         * then, once the batch has been computed, finishUpdate() takes the coefficients from that lane.
+         */
+        void beginUpdate(float frequency, ResonatorCoefficientBatch& batch);
+        void finishUpdate(const ResonatorCoefficientBatch& batch, int numSamples);
+        /**
+         * Keeps the current parameters for the next numSamples samples, in place of updateParameters().
+         */
+        void keepParameters(int numSamples);
         void copyParameters(StereoResonator::Resonator& other);
 
+        /**
+         * Whether this resonator's parameters, after per-channel modulation, are exactly those of the other one,
+         * i.e. whether the two produce the same output from the same state and input.
+         */
+        bool hasSameParametersAs(const Resonator& other) const;
+
+        /**
+         * Copies the other resonator's internal state (delay line, filter states, activity), but not its parameters:
+         * the delay length glides on from the other's current value to this resonator's own target.
+         */
+        void copyStateFrom(const Resonator& other);
+
+        //hot: everything the per-sample loop touches, first and starting on its own cache line
+        alignas(64) ResonatorDelayLine delayLine;
+        InterpolatedValue delayLengthInterpolator;
+        WaveguideLoopFilter loopFilter;
+        DispersionFilter apf;
+        chowdsp::SVFMultiMode<float, 1, false> postFilter;
+        float decayCoefficient; //the first-order damping coefficient
+        float gain;
+        float postFilterNormalizationScalar = 1;
+        bool passthrough = false;
+        float passthroughSample;
+
+        static constexpr float silenceThreshold = 1.0e-5f; //-100 dB
+        float meanSquare = 0.0f; //mean square of the samples pushed into the delay line during the last block
+        int quietSamples = 0; //how many consecutive samples pushed into the delay line were below the silence threshold
+        bool sleeping = false;
+
+        //cold: only read once per block, when parameters are updated
         ResonatorVoice& voice;
-        ResonatorParams params;
+        const ResonatorParams& params;
         int channel = 0;
         float minFrequency = 1.0f;
         float maxFrequency = 22000.0f;
         float delayLengthInSamples = -1; //the length of the delay line in samples corresponding to frequency
-        float decayCoefficient; //the first-order damping coefficient
         float sampleRate;
-
-        bool passthrough = false;
-        float passthroughSample;
-
-        float gain;
         bool keytrack = true;
-        float lastFrequency;
-        float nextFrequency;
-        float dispersion;
+        float lastFrequency = -1.0f;
+        float nextFrequency = -1.0f;
+        float dispersion = -1.0f;
         bool loopFilterKeytrack = false;
         bool postFilterKeytrack = false;
-        float postFilterNormalizationScalar = 1;
+        float postFilterCutoff = 0.0f;
+        float postFilterResonance = 0.0f;
+        float postFilterMode = 0.0f;
         float loopFilterPhaseDelay = -999999;
 
-        InterpolatedValue delayLengthInterpolator;
-
-        chowdsp::DelayLine<float, chowdsp::DelayLineInterpolationTypes::Lagrange3rd> delayLine;
-        chowdsp::SVFMultiMode<float, 1, true> loopFilter;
-        chowdsp::SVFMultiMode<float, 1, false> postFilter;
-        DispersionFilter apf;
+        struct
+        {
+            ModValueTable::Handle gain, pitch, frequency, decayTime, dispersion,
+                loopFilterCutoff, loopFilterPitchInSemis, loopFilterResonance,
+                postFilterCutoff, postFilterPitchInSemis, postFilterResonance, postFilterMode;
+        } modHandles {}; //where the parameters are read from, in the voice's ModValueTable
+        int coefficientLane = -1; //this resonator's lane in the batch, between beginUpdate() and finishUpdate()
+        bool postFilterDirty = true; //set by prepare(), which may reset the post filter's coefficients
+        //never processes audio; used to estimate the loop filter's phase delay for tuning compensation
+        chowdsp::SVFMultiMode<float, 1, true> loopFilterPrototype;
     };
 
-public:
-    StereoResonator(ResonatorVoice& voice, ResonatorParams params)
-        : voice(voice), params(params),
-          resonators{{voice, params, 0}, {voice, params, 1}}, left(resonators[0]), right(resonators[1]), resonatorIndex(params.resonatorIndex)
+    /**
+     * params must outlive the resonator; it is normally the owning bank's own copy.
+     */
+    StereoResonator(ResonatorVoice& voice, const ResonatorParams& params)
+        : resonators{{voice, params, 0}, {voice, params, 1}}, voice(voice), params(params),
+          left(resonators[0]), right(resonators[1]), resonatorIndex(params.resonatorIndex),
+          trackedParameters{
+              params.enabled, params.pitch, params.frequency, params.resonatorKeytrack,
+              params.decayTime, params.dispersion, params.loopFilterCutoff,
+              params.loopFilterPitchInSemis, params.loopFilterResonance, params.loopFilterType,
+              params.loopFilterKeytrack, params.postFilterCutoff, params.postFilterPitchInSemis,
+              params.postFilterResonance, params.postFilterMode, params.postFilterKeytrack,
+              params.gain
+          }
     {
     }
 
-    ResonatorVoice& voice;
-    ResonatorParams params;
     Resonator resonators[2];
+    bool enabled;
+    //true while both channels are known to be in exactly the same state, in which case only the left channel is
+    //processed and its output is used for both. Set on reset, and cleared for the rest of the note
+    //as soon as the channels' parameters or inputs differ (see updateCollapse()).
+    bool collapsed = false;
+
+    ResonatorVoice& voice;
+    const ResonatorParams& params;
     Resonator& left; //handy aliases
     Resonator& right;
-    bool enabled;
     int resonatorIndex;
 
+    //every parameter that Resonator::updateParameters() reads, and their normalised values at the last update;
+    //while none of them is modulated or still settling after a change, and the voice's frequency is unchanged,
+    //there is nothing to update
+    std::array<gin::Parameter*, 17> trackedParameters;
+    std::array<float, 17> lastParameterValues {};
+    float lastVoiceFrequency = -1.0f;
+    //the values read lag behind a change while the mod matrix smooths it, so updates go on for settlingSamples after it
+    int samplesSinceChange = -1; //-1 once the last change has settled
+    int settlingSamples = 0;
+    bool modulated = false;
+    bool parametersDirty = true; //set on reset, and while disabled, to force the next update
+    bool updatePending = false; //between beginUpdate() and finishUpdate(), whether the channels are being updated
+
     float processSample(float input, int channel);
 
     /**
@@ -111,11 +230,35 @@ public:
      * An invocation of this function should generally be preceeded by an invocation of popSample().
      */
     void pushSample(float input, int channel);
+    /**
+     * Processes a block of a single channel. See Resonator::processBlock().
+     */
+    void processBlock(const float* in, float* out, int numSamples, int channel);
     float postProcess(float sample, int channel);
     void reset();
     void prepare(const juce::dsp::ProcessSpec& spec);
+    void addModParameters(ModValueTable& table);
     void updateParameters(float frequency, int numSamples, bool force = false);
+    /**
+     * updateParameters() in two stages, with the coefficients of both channels computed in the given batch,
+     * which the caller computes in between. See Resonator::beginUpdate().
+     */
+    void beginUpdate(float frequency, int numSamples, ResonatorCoefficientBatch& batch, bool force = false);
+    void finishUpdate(const ResonatorCoefficientBatch& batch, int numSamples);
+
+    /**
+     * Called before each block is processed. If the channels were collapsed, but their parameters now differ
+     * or the two input channels are not identical, the right channel takes over the left channel's state
+     * so that processing resumes seamlessly in stereo.
+     * @return whether the channels are still collapsed, i.e. whether only the left channel should be processed.
+     */
+    bool updateCollapse(bool inputsIdentical);
 private:
+    /**
+     * Whether any tracked parameter's value has changed since the last call, or is (or was until now) modulated.
+     */
+    bool parametersChanged();
+
     static constexpr double INV_SQRT_2 = 0.7071067811865475244008443621048490392848359376884740365883398689;
 };
 
@@ -0,0 +1,200 @@
+#include "VoiceGroupRenderer.h"
+#include "ResonatorVoice.h"
+#include <melatonin_perfetto/melatonin_perfetto.h>
+
+void VoiceGroupRenderer::render(ResonatorVoice* const* voices, int numVoices, int startSample, int numSamples)
+{
+    TRACE_DSP("voices", numVoices);
+    StageProfiler::ScopedStage stage(numVoices > 0 ? &voices[0]->state.profiler : nullptr, StageProfiler::voiceRender);
+    jassert(numVoices <= VOICE_GROUP_SIZE);
+    for (int v = 0; v < numVoices; v++)
+    {
+        voices[v]->beginBlock(startSample, numSamples);
+    }
+
+    renderBanks(voices, numVoices, 0, NUM_RESONATOR_BANKS, startSample, numSamples);
+
+    for (int v = 0; v < numVoices; v++)
+    {
+        voices[v]->endBlock(voices[v]->renderBuffer, startSample, numSamples);
+    }
+}
+
+void VoiceGroupRenderer::renderBanks(ResonatorVoice* const* voices, int numVoices, int firstBank, int endBank,
+                                     int startSample, int numSamples)
+{
+    //bank by bank, since a bank may read the previous bank's output
+    for (int b = firstBank; b < endBank; b++)
+    {
+        numGroupedBanks = 0;
+        for (int v = 0; v < numVoices; v++)
+        {
+            auto* voice = voices[v];
+            if (voice->bypassResonators) continue;
+
+            auto& bank = *voice->resonatorBanks[b];
+            auto exciterBlock = voice->getExciterBlock(startSample, numSamples);
+            auto bankBlock = voice->beginResonatorBank(b, startSample, numSamples);
+            bool inputActive = false;
+            if (!canJoinGroup(bank))
+            {
+                bank.process(exciterBlock, bankBlock);
+                voice->finishResonatorBank(b, bankBlock);
+            }
+            else if (bank.beginProcess(exciterBlock, bankBlock, inputActive))
+            {
+                groupedBanks[static_cast<size_t>(numGroupedBanks++)] = {voice, &bank, exciterBlock, bankBlock, inputActive, 0, 0};
+            }
+            else
+            {
+                voice->finishResonatorBank(b, bankBlock);
+            }
+        }
+
+        if (numGroupedBanks == 0) continue;
+        {
+            TRACE_DSP("bank", b);
+            StageProfiler::ScopedStage bankStage(&voices[0]->state.profiler,
+                                                 static_cast<StageProfiler::Stage>(StageProfiler::resonatorBank1 + b));
+            renderCoupledBanks(numSamples);
+        }
+        for (int g = 0; g < numGroupedBanks; g++)
+        {
+            auto& groupedBank = groupedBanks[static_cast<size_t>(g)];
+            groupedBank.bank->updateActivity(numSamples, groupedBank.inputActive);
+            groupedBank.voice->finishResonatorBank(b, groupedBank.bankBlock);
+        }
+    }
+}
+
+bool VoiceGroupRenderer::canJoinGroup(const WaveguideResonatorBank& bank)
+{
+    if (bank.couplingMode == WaveguideResonatorBank::PARALLEL) return false;
+    if (bank.convolutionTail > 0) return false; //only process() plays out the tail of a bank that was baked
+    for (const auto* r : bank.resonators)
+    {
+        if (r->enabled && (r->resonators[0].passthrough || r->resonators[1].passthrough)) return false;
+    }
+    return true;
+}
+
+/**
+ * The per-sample loops of WaveguideResonatorBank::process() in the coupled modes, for every grouped bank at once.
+ * The delay-line reads and loop filters of every lane come out of the kernel in one go;
+ * each bank then computes its own couplings and output from its lanes.
+ */
+void VoiceGroupRenderer::renderCoupledBanks(int numSamples)
+{
+    kernel.clear();
+    for (int g = 0; g < numGroupedBanks; g++)
+    {
+        auto& groupedBank = groupedBanks[static_cast<size_t>(g)];
+        groupedBank.firstLane = kernel.getNumLanes();
+        for (int j = 0; j < NUM_RESONATORS; j++)
+        {
+            auto* r = groupedBank.bank->resonators[j];
+            if (!r->enabled) continue;
+            for (auto& resonator : r->resonators)
+            {
+                laneResonators[static_cast<size_t>(kernel.getNumLanes())] = j;
+                kernel.addLane(resonator);
+            }
+        }
+        groupedBank.numLanes = kernel.getNumLanes() - groupedBank.firstLane;
+    }
+    kernel.load();
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float* out = kernel.popSamples();
+        for (int g = 0; g < numGroupedBanks; g++)
+        {
+            auto& groupedBank = groupedBanks[static_cast<size_t>(g)];
+            auto& bank = *groupedBank.bank;
+            auto& voice = *groupedBank.voice;
+            const int* resonatorIndices = laneResonators.data() + groupedBank.firstLane;
+            const float* bankOut = out + groupedBank.firstLane;
+            float* push = laneInputs.data() + groupedBank.firstLane;
+
+            const float inSampleL = (groupedBank.exciterBlock.getSample(0, i) * bank.exciterMix
+                                     + groupedBank.bankBlock.getSample(0, i) * bank.previousResonatorBankMix) * bank.inputGain;
+            const float inSampleR = (groupedBank.exciterBlock.getSample(1, i) * bank.exciterMix
+                                     + groupedBank.bankBlock.getSample(1, i) * bank.previousResonatorBankMix) * bank.inputGain;
+            const bool solo = bank.state.soloActive && bank.state.soloBankIndex == bank.index;
+            float outSampleL = 0.0f;
+            float outSampleR = 0.0f;
+
+            if (bank.couplingMode == WaveguideResonatorBank::INTERLINKED)
+            {
+                float feedbackSampleL = 0.0f;
+                float feedbackSampleR = 0.0f;
+                float soloSampleL = 0.0f;
+                float soloSampleR = 0.0f;
+                for (int l = 0; l < groupedBank.numLanes; l += 2)
+                {
+                    auto* r = bank.resonators[resonatorIndices[l]];
+                    feedbackSampleL += bankOut[l] * (r->resonators[0].gain / bank.totalGainL);
+                    feedbackSampleR += bankOut[l + 1] * (r->resonators[1].gain / bank.totalGainR);
+                    //as in the scalar loop, both post filters are fed from the left channel
+                    outSampleL += r->postProcess(bankOut[l], 0) * r->resonators[0].gain;
+                    outSampleR += r->postProcess(bankOut[l], 1) * r->resonators[1].gain;
+                    if (resonatorIndices[l] == bank.state.soloResonatorIndex)
+                    {
+                        soloSampleL = bankOut[l];
+                        soloSampleR = bankOut[l + 1];
+                    }
+                }
+
+                if (solo)
+                {
+                    voice.soloBuffer.setSample(0, voice.currentBlockStartSample + i, soloSampleL);
+                    voice.soloBuffer.setSample(1, voice.currentBlockStartSample + i, soloSampleR);
+                }
+
+                //the bridge filter H(z) = -2 / totalGain, see WaveguideResonatorBank::process
+                feedbackSampleL = -2.0f * feedbackSampleL;
+                feedbackSampleR = -2.0f * feedbackSampleR;
+                for (int l = 0; l < groupedBank.numLanes; l += 2)
+                {
+                    push[l] = feedbackSampleL + bankOut[l] + inSampleL;
+                    push[l + 1] = feedbackSampleR + bankOut[l + 1] + inSampleR;
+                }
+            }
+            else
+            {
+                jassert(bank.couplingMode == WaveguideResonatorBank::CASCADE);
+                float previousResonatorSampleL = 0.0f;
+                float previousResonatorSampleR = 0.0f;
+                for (int l = 0; l < groupedBank.numLanes; l += 2)
+                {
+                    const int j = resonatorIndices[l];
+                    auto* r = bank.resonators[j];
+                    const float processedFwdSampleL = bank.cascadeFilterL.processSample(
+                        j, bank.dcBlockersL[j].processSample(previousResonatorSampleL) * bank.cascadeAmountL);
+                    const float processedFwdSampleR = bank.cascadeFilterR.processSample(
+                        j, bank.dcBlockersR[j].processSample(previousResonatorSampleR) * bank.cascadeAmountR);
+                    push[l] = bankOut[l] + processedFwdSampleL + inSampleL;
+                    push[l + 1] = bankOut[l + 1] + processedFwdSampleR + inSampleR;
+                    previousResonatorSampleL = bankOut[l];
+                    previousResonatorSampleR = bankOut[l + 1];
+
+                    const float soloOutSampleL = r->postProcess(bankOut[l], 0) * r->resonators[0].gain;
+                    const float soloOutSampleR = r->postProcess(bankOut[l + 1], 1) * r->resonators[1].gain;
+                    outSampleL += soloOutSampleL;
+                    outSampleR += soloOutSampleR;
+                    if (solo && j == bank.state.soloResonatorIndex)
+                    {
+                        voice.soloBuffer.setSample(0, voice.currentBlockStartSample + i, soloOutSampleL);
+                        voice.soloBuffer.setSample(1, voice.currentBlockStartSample + i, soloOutSampleR);
+                    }
+                }
+            }
+
+            groupedBank.bankBlock.setSample(0, i, outSampleL * bank.outputGain);
+            groupedBank.bankBlock.setSample(1, i, outSampleR * bank.outputGain);
+        }
+        kernel.pushSamples(laneInputs.data());
+    }
+
+    kernel.store();
+}
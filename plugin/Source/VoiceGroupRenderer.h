@@ -0,0 +1,62 @@
+#ifndef VOICEGROUPRENDERER_H
+#define VOICEGROUPRENDERER_H
+
+#include "defines.h"
+#include "ResonatorLaneKernel.h"
+
+class ResonatorVoice;
+class WaveguideResonatorBank;
+
+/**
+ * Renders a group of up to VOICE_GROUP_SIZE voices together, bank by bank.
+ *
+ * In the coupled modes (INTERLINKED and CASCADE), the resonators of a bank feed each other within every sample,
+ * so a bank has to run its waveguide loops one sample at a time, and a single bank rarely has enough resonators
+ * to fill the SIMD registers. Every voice has the same topology, though, so the loops of the same bank
+ * in several voices can run in lockstep: one SIMD lane per resonator channel per voice, in a VoiceGroupLaneKernel.
+ * The couplings themselves (feedback sums, cascade filters) and the post filters are still computed per lane.
+ *
+ * Disabled resonators get no lane, so voices whose banks have different sets of enabled resonators are simply masked.
+ * Banks in PARALLEL mode, which already vectorise across their resonators, and banks with passthrough resonators
+ * are processed by their own voice, as usual.
+ */
+class VoiceGroupRenderer
+{
+public:
+    /**
+     * Renders every voice into its own renderBuffer, which must have been cleared. Equivalent to calling
+     * renderNextBlock(voice->renderBuffer, startSample, numSamples) on every voice.
+     */
+    void render(ResonatorVoice* const* voices, int numVoices, int startSample, int numSamples);
+
+    /**
+     * Renders only the banks from firstBank up to (but not including) endBank of every voice.
+     * The voices must have begun the block (see ResonatorVoice::beginBlock()), and if firstBank reads the previous bank,
+     * the previous bank must already have been rendered.
+     */
+    void renderBanks(ResonatorVoice* const* voices, int numVoices, int firstBank, int endBank,
+                     int startSample, int numSamples);
+
+private:
+    struct GroupedBank
+    {
+        ResonatorVoice* voice;
+        WaveguideResonatorBank* bank;
+        juce::dsp::AudioBlock<float> exciterBlock;
+        juce::dsp::AudioBlock<float> bankBlock;
+        bool inputActive;
+        int firstLane; //the bank's lanes are consecutive, left and right channel of each enabled resonator in turn
+        int numLanes;
+    };
+
+    static bool canJoinGroup(const WaveguideResonatorBank& bank);
+    void renderCoupledBanks(int numSamples);
+
+    VoiceGroupLaneKernel kernel;
+    std::array<GroupedBank, VOICE_GROUP_SIZE> groupedBanks;
+    int numGroupedBanks = 0;
+    std::array<int, VoiceGroupLaneKernel::maxLanes> laneResonators {}; //the index of each lane's resonator in its bank
+    std::array<float, VoiceGroupLaneKernel::maxLanes> laneInputs {}; //what is pushed into each lane
+};
+
+#endif //VOICEGROUPRENDERER_H
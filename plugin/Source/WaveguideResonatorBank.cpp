@@ -1,5 +1,6 @@
 #include "WaveguideResonatorBank.h"
 #include "ResonatorVoice.h"
+#include <melatonin_perfetto/melatonin_perfetto.h>
 
 WaveguideResonatorBank::WaveguideResonatorBank(GlobalState& state, ResonatorVoice& parentVoice,
                                                WaveguideResonatorBankParams params) :
@@ -11,7 +12,8 @@ WaveguideResonatorBank::WaveguideResonatorBank(GlobalState& state, ResonatorVoic
         new juce::dsp::IIR::Coefficients<float>(1, -1, 1, -0.995f);
     for (int i = 0; i < NUM_RESONATORS; i++)
     {
-        resonators.add(new StereoResonator(parentVoice, params.resonatorParams[i]));
+        //the resonators refer to the bank's own copy of their parameters, not to the constructor argument
+        resonators.add(parentVoice, this->params.resonatorParams[i]);
         dcBlockersL[i] = juce::dsp::IIR::Filter<float>(dcBlockerCoefficients);
         dcBlockersR[i] = juce::dsp::IIR::Filter<float>(dcBlockerCoefficients);
         dcBlockersL[i].coefficients = dcBlockerCoefficients;
@@ -25,7 +27,6 @@ WaveguideResonatorBank::WaveguideResonatorBank(GlobalState& state, ResonatorVoic
 
 WaveguideResonatorBank::~WaveguideResonatorBank()
 {
-    resonators.clear(true);
 }
 
 /**
@@ -42,13 +43,37 @@ void WaveguideResonatorBank::reset()
     }
     cascadeFilterL.reset();
     cascadeFilterR.reset();
+    sleeping = false;
+    releaseBake();
+    bakeCandidate = true;
     // testInterlinkedFilterL.reset();
     // testInterlinkedFilterR.reset();
 }
 
+/**
+ * Adds the parameters of the bank and its resonators to the voice's ModValueTable. Must be called before prepare().
+ */
+void WaveguideResonatorBank::addModParameters(ModValueTable& table)
+{
+    modHandles.couplingMode = table.addParameter(params.couplingMode);
+    modHandles.inputGain = table.addParameter(params.inputGain);
+    modHandles.inputMix = table.addParameter(params.inputMix);
+    modHandles.outputGain = table.addParameter(params.outputGain);
+    modHandles.cascadeLevel = table.addParameter(params.cascadeLevel);
+    modHandles.cascadeFilterCutoff = table.addParameter(params.cascadeFilterCutoff);
+    modHandles.cascadeFilterResonance = table.addParameter(params.cascadeFilterResonance);
+    modHandles.cascadeFilterMode = table.addParameter(params.cascadeFilterMode);
+    for (auto* r : resonators)
+    {
+        r->addModParameters(table);
+    }
+}
+
 void WaveguideResonatorBank::prepare(const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
+    inputBuffer.setSize(2, static_cast<int>(spec.maximumBlockSize), false, true, true);
+    laneBuffer.setSize(2 * NUM_RESONATORS, static_cast<int>(spec.maximumBlockSize), false, true, true);
     cascadeFilterL.prepare(spec);
     cascadeFilterR.prepare(spec);
     testInterlinkedFilterL.prepare(spec);
@@ -82,15 +107,148 @@ void WaveguideResonatorBank::prepare(const juce::dsp::ProcessSpec& spec)
 void WaveguideResonatorBank::updateParameters(float newFrequency, int numSamples)
 {
     frequency = newFrequency;
-    couplingMode = static_cast<CouplingMode>(voice.getValue(params.couplingMode));
-    previousResonatorBankMix = voice.getValue(params.inputMix);
-    exciterMix = 1 - voice.getValue(params.inputMix);
+    couplingMode = static_cast<CouplingMode>(voice.modValues.get(modHandles.couplingMode));
+    previousResonatorBankMix = voice.modValues.get(modHandles.inputMix);
+    exciterMix = 1 - voice.modValues.get(modHandles.inputMix);
     previousResonatorBankMix *= 0.5f; //scale down a little to taste
-    inputGain = voice.getValue(params.inputGain);
-    outputGain = voice.getValue(params.outputGain);
+    inputGain = voice.modValues.get(modHandles.inputGain);
+    outputGain = voice.modValues.get(modHandles.outputGain);
+    //the coefficients of every resonator channel in the bank are computed together, in one batch
+    coefficientBatch.clear();
     for (auto* r : resonators)
     {
-        r->updateParameters(newFrequency, numSamples);
+        r->beginUpdate(newFrequency, numSamples, coefficientBatch);
+    }
+    coefficientBatch.compute(sampleRate);
+    bool resonatorsChanged = false;
+    juce::uint32 newEnabledResonators = 0;
+    for (int j = 0; j < NUM_RESONATORS; j++)
+    {
+        resonatorsChanged = resonatorsChanged || resonators[j]->updatePending;
+        if (resonators[j]->enabled) newEnabledResonators |= 1u << j;
+        resonators[j]->finishUpdate(coefficientBatch, numSamples);
+    }
+    resonatorsChanged = resonatorsChanged || newEnabledResonators != enabledResonators;
+    enabledResonators = newEnabledResonators;
+
+    //compute the total gain so that the output can be normalized,
+    //used by all resonator bank processing modes
+    totalGainL = 0.0f;
+    totalGainR = 0.0f;
+    for (const auto* r : resonators)
+    {
+        totalGainL = totalGainL + r->resonators[0].gain;
+        totalGainR = totalGainR + r->resonators[1].gain;
+    }
+
+    if (couplingMode == CASCADE)
+    {
+        cascadeAmountL = voice.modValues.get(modHandles.cascadeLevel, 0);
+        cascadeAmountR = voice.modValues.get(modHandles.cascadeLevel, 1);
+
+        const float newCutoffL = voice.modValues.get(modHandles.cascadeFilterCutoff, 0);
+        const float newResonanceL = voice.modValues.get(modHandles.cascadeFilterResonance, 0);
+        const float newModeL = voice.modValues.get(modHandles.cascadeFilterMode, 0);
+        cascadeFilterL.updateParameters(newCutoffL, newResonanceL, newModeL);
+
+        const float newCutoffR = voice.modValues.get(modHandles.cascadeFilterCutoff, 1);
+        const float newResonanceR = voice.modValues.get(modHandles.cascadeFilterResonance, 1);
+        const float newModeR = voice.modValues.get(modHandles.cascadeFilterMode, 1);
+        cascadeFilterR.updateParameters(newCutoffR, newResonanceR, newModeR);
+    }
+
+    updateBake(resonatorsChanged, numSamples);
+}
+
+bool WaveguideResonatorBank::readsPreviousBank() const
+{
+    return previousResonatorBankMix != 0.0f || totalGainL == 0.0f || totalGainR == 0.0f;
+}
+
+bool WaveguideResonatorBank::canBake() const
+{
+    if (!state.bakeResonators || state.impulseResponseBaker == nullptr) return false;
+    if (state.soloActive || couplingMode != PARALLEL) return false; //soloing needs every resonator's own output
+    bool anyEnabled = false;
+    for (const auto* r : resonators)
+    {
+        if (!r->enabled) continue;
+        if (r->modulated) return false;
+        //every note can bend, through MPE or the pitch wheel, and glide; a bank that follows the note's pitch
+        //would have to hand its ringing state back to the resonators then, so it is played live instead
+        for (const auto& resonator : r->resonators)
+        {
+            if (resonator.keytrack || resonator.loopFilterKeytrack || resonator.postFilterKeytrack) return false;
+        }
+        anyEnabled = true;
+    }
+    return anyEnabled;
+}
+
+/**
+ * Looks up the impulse response of the bank, as just updated for a new note, and switches to it if it is ready.
+ * Otherwise the note plays live, and the bank is queued to be baked for the next note like it.
+ */
+void WaveguideResonatorBank::startBake()
+{
+    auto& baker = *state.impulseResponseBaker;
+    const auto key = ImpulseResponseBaker::getKey(*this);
+    bool rejected;
+    bakeLease = baker.acquire(key, rejected);
+    if (bakeLease.response == nullptr)
+    {
+        if (!rejected) baker.requestBake(key, *this);
+        return;
+    }
+
+    convolutionState = baker.acquireState();
+    if (convolutionState == nullptr)
+    {
+        baker.release(bakeLease); //too many banks are baked already
+        return;
+    }
+    convolvers[0].reset(*bakeLease.response->channels[0], convolutionState);
+    convolvers[1].reset(*bakeLease.response->channels[1], convolutionState + baker.getChannelStateSize());
+    baked = true;
+    bakedKey = key;
+    samplesSinceInput = 0;
+}
+
+void WaveguideResonatorBank::releaseBake()
+{
+    if (convolutionState != nullptr)
+    {
+        state.impulseResponseBaker->releaseState(convolutionState);
+        convolutionState = nullptr;
+    }
+    if (bakeLease.response != nullptr)
+    {
+        state.impulseResponseBaker->release(bakeLease);
+    }
+    baked = false;
+    convolutionTail = 0;
+}
+
+/**
+ * Bakes the bank at the first update of a note, and unbakes it as soon as its impulse response changes.
+ * Only banks that do not follow the note's pitch are baked (see canBake()), so bends and glides never get here;
+ * what does is a parameter change, or the start of a modulation. The resonators were left untouched, i.e. silent,
+ * while the bank was baked, so they take over from there, with the new parameters applied to the input from now on;
+ * the convolution keeps playing out the response to its past input alongside them, until it has decayed.
+ */
+void WaveguideResonatorBank::updateBake(bool resonatorsChanged, int numSamples)
+{
+    //the resonators are also updated when only the note's frequency changed, which leaves a baked bank as it is
+    if (baked && (!canBake() || (resonatorsChanged && ImpulseResponseBaker::getKey(*this) != bakedKey)))
+    {
+        baked = false;
+        convolutionTail = bakeLease.response->length;
+    }
+
+    if (bakeCandidate && numSamples > 0)
+    {
+        bakeCandidate = false;
+        if (canBake()) startBake();
     }
 }
 
@@ -104,59 +262,24 @@ void WaveguideResonatorBank::updateParameters(float newFrequency, int numSamples
 void WaveguideResonatorBank::process(juce::dsp::AudioBlock<float>& exciterBlock,
                                      juce::dsp::AudioBlock<float>& previousResonatorBankBlock)
 {
-    //reminder: the outputBlock may already have samples inside...
-    jassert(exciterBlock.getNumSamples() == previousResonatorBankBlock.getNumSamples());
-    jassert(exciterBlock.getNumChannels() == previousResonatorBankBlock.getNumChannels());
-
-    //compute the total gain so that the output can be normalized,
-    //used by all resonator bank processing modes
-    float totalGainL = 0.0f;
-    float totalGainR = 0.0f;
-    for (const auto* r : resonators)
+    TRACE_DSP("bank", index);
+    StageProfiler::ScopedStage stage(&state.profiler, static_cast<StageProfiler::Stage>(StageProfiler::resonatorBank1 + index));
+    bool inputActive;
+    if (!beginProcess(exciterBlock, previousResonatorBankBlock, inputActive))
     {
-        totalGainL = totalGainL + r->resonators[0].gain;
-        totalGainR = totalGainR + r->resonators[1].gain;
+        if (convolutionTail > 0) releaseBake();
+        return;
     }
 
-    if (totalGainL == 0.0f || totalGainR == 0.0f) return;
-
+    if (couplingMode == PARALLEL && baked)
+    {
+        processBaked(exciterBlock, previousResonatorBankBlock);
+        updateBakedActivity(static_cast<int>(exciterBlock.getNumSamples()), inputActive);
+        return;
+    }
     if (couplingMode == PARALLEL)
     {
-        for (int i = 0; i < exciterBlock.getNumSamples(); i++)
-        {
-            float outSampleL = 0.0f;
-            float outSampleR = 0.0f;
-            for (int j = 0; j < NUM_RESONATORS; j++)
-            {
-                if (resonators[j]->enabled)
-                {
-                    const float inSampleL = (exciterBlock.getSample(0, i) * exciterMix + previousResonatorBankBlock.
-                        getSample(0, i) * previousResonatorBankMix) * inputGain;
-                    const float inSampleR = (exciterBlock.getSample(1, i) * exciterMix + previousResonatorBankBlock.
-                        getSample(1, i) * previousResonatorBankMix) * inputGain;
-                    const float soloOutSampleL = resonators[j]->left.postProcess(
-                        resonators[j]->left.processSample(inSampleL)) * resonators[j]->left.gain;
-                    const float soloOutSampleR = resonators[j]->right.postProcess(
-                        resonators[j]->right.processSample(inSampleR)) * resonators[j]->right.gain;
-                    outSampleL += soloOutSampleL;
-                    outSampleR += soloOutSampleR;
-
-                    if (state.soloActive &&
-                        state.soloBankIndex == index &&
-                        state.soloResonatorIndex == resonators[j]->resonatorIndex)
-                    {
-                        voice.soloBuffer.setSample(0, voice.currentBlockStartSample + i, soloOutSampleL);
-                        voice.soloBuffer.setSample(1, voice.currentBlockStartSample + i, soloOutSampleR);
-                    }
-                }
-            }
-            outSampleL = (outSampleL / totalGainL) * outputGain;
-            outSampleR = (outSampleR / totalGainR) * outputGain;
-
-
-            previousResonatorBankBlock.setSample(0, i, outSampleL);
-            previousResonatorBankBlock.setSample(1, i, outSampleR);
-        }
+        processParallel(exciterBlock, previousResonatorBankBlock, inputActive);
     }
     else if (couplingMode == INTERLINKED)
     {
@@ -213,19 +336,6 @@ void WaveguideResonatorBank::process(juce::dsp::AudioBlock<float>& exciterBlock,
     }
     else if (couplingMode == CASCADE)
     {
-        const float cascadeAmountL = voice.getValue(params.cascadeLevel, 0);
-        const float cascadeAmountR = voice.getValue(params.cascadeLevel, 1);
-
-        const float newCutoffL = voice.getValue(params.cascadeFilterCutoff, 0);
-        const float newResonanceL = voice.getValue(params.cascadeFilterResonance, 0);
-        const float newModeL = voice.getValue(params.cascadeFilterMode, 0);
-        cascadeFilterL.updateParameters(newCutoffL, newResonanceL, newModeL);
-
-        const float newCutoffR = voice.getValue(params.cascadeFilterCutoff, 1);
-        const float newResonanceR = voice.getValue(params.cascadeFilterResonance, 1);
-        const float newModeR = voice.getValue(params.cascadeFilterMode, 1);
-        cascadeFilterR.updateParameters(newCutoffR, newResonanceR, newModeR);
-
         for (int i = 0; i < exciterBlock.getNumSamples(); i++)
         {
             float previousResonatorSampleL = 0.0f;
@@ -276,6 +386,293 @@ void WaveguideResonatorBank::process(juce::dsp::AudioBlock<float>& exciterBlock,
         DBG("Invalid feedback mode!");
         jassertfalse;
     }
+
+    if (convolutionTail > 0)
+    {
+        addConvolutionTail(previousResonatorBankBlock);
+    }
+    updateActivity(static_cast<int>(exciterBlock.getNumSamples()), inputActive);
+}
+
+/**
+ * Everything that process() does before the resonators themselves are processed:
+ * skips a bank without gain, keeps the bank asleep while it has no input, and wakes up or collapses its resonators.
+ * Returns false if there is nothing to process, in which case the output block has already been taken care of;
+ * otherwise, the resonators must be processed, followed by a call to updateActivity().
+ */
+bool WaveguideResonatorBank::beginProcess(juce::dsp::AudioBlock<float>& exciterBlock,
+                                          juce::dsp::AudioBlock<float>& previousResonatorBankBlock,
+                                          bool& inputActive)
+{
+    //reminder: the outputBlock may already have samples inside...
+    jassert(exciterBlock.getNumSamples() == previousResonatorBankBlock.getNumSamples());
+    jassert(exciterBlock.getNumChannels() == previousResonatorBankBlock.getNumChannels());
+
+    if (totalGainL == 0.0f || totalGainR == 0.0f) return false;
+
+    const int numSamples = static_cast<int>(exciterBlock.getNumSamples());
+    inputActive = getInputPeak(exciterBlock, previousResonatorBankBlock) > StereoResonator::Resonator::silenceThreshold;
+    if (sleeping)
+    {
+        if (!inputActive)
+        {
+            previousResonatorBankBlock.clear();
+            if (state.soloActive && state.soloBankIndex == index)
+            {
+                voice.soloBuffer.clear(voice.currentBlockStartSample, numSamples);
+            }
+            return false;
+        }
+        sleeping = false;
+    }
+
+    //in the coupled modes, resonators only ever sleep together with their bank
+    if (couplingMode != PARALLEL)
+    {
+        for (auto* r : resonators)
+        {
+            for (auto& resonator : r->resonators)
+            {
+                if (resonator.sleeping) resonator.wake();
+            }
+        }
+    }
+
+    //a resonator whose channels have the same parameters and the same input only needs to process one of them;
+    //only PARALLEL mode takes advantage of this, so the coupled modes always expand their resonators back to stereo
+    const bool inputsIdentical = couplingMode == PARALLEL
+        && channelsAreIdentical(exciterBlock) && channelsAreIdentical(previousResonatorBankBlock);
+    for (auto* r : resonators)
+    {
+        if (r->enabled) r->updateCollapse(inputsIdentical);
+    }
+    return true;
+}
+
+/**
+ * Returns an upper bound on the peak amplitude of this bank's input over the block,
+ * i.e. of the mix of the exciters and the previous bank.
+ */
+float WaveguideResonatorBank::getInputPeak(const juce::dsp::AudioBlock<float>& exciterBlock,
+                                           const juce::dsp::AudioBlock<float>& previousResonatorBankBlock) const
+{
+    const auto exciterRange = exciterBlock.findMinAndMax();
+    const auto previousRange = previousResonatorBankBlock.findMinAndMax();
+    const float exciterPeak = juce::jmax(std::abs(exciterRange.getStart()), std::abs(exciterRange.getEnd()));
+    const float previousPeak = juce::jmax(std::abs(previousRange.getStart()), std::abs(previousRange.getEnd()));
+    return (exciterPeak * std::abs(exciterMix) + previousPeak * std::abs(previousResonatorBankMix)) * std::abs(inputGain);
+}
+
+bool WaveguideResonatorBank::channelsAreIdentical(const juce::dsp::AudioBlock<float>& block)
+{
+    return std::memcmp(block.getChannelPointer(0), block.getChannelPointer(1), block.getNumSamples() * sizeof(float)) == 0;
+}
+
+/**
+ * Updates the activity of every enabled resonator after a block has been processed.
+ * In PARALLEL mode, quiet resonators are put to sleep individually;
+ * in the coupled modes, the bank only goes to sleep once all of its resonators are quiet.
+ */
+void WaveguideResonatorBank::updateActivity(int numSamples, bool inputActive)
+{
+    bool allQuiet = true;
+    for (auto* r : resonators)
+    {
+        if (!r->enabled) continue;
+        for (auto& resonator : r->resonators)
+        {
+            if (r->collapsed && &resonator == &r->right) continue; //left's activity stands for both channels
+            resonator.updateActivity(numSamples);
+            if (!resonator.isQuiet())
+            {
+                allQuiet = false;
+            }
+            else if (couplingMode == PARALLEL && !resonator.passthrough && !inputActive)
+            {
+                resonator.sleep();
+            }
+        }
+    }
+    sleeping = allQuiet && !inputActive && convolutionTail == 0;
+}
+
+/**
+ * A baked bank is silent once its impulse response has played out since the last input.
+ */
+void WaveguideResonatorBank::updateBakedActivity(int numSamples, bool inputActive)
+{
+    samplesSinceInput = inputActive ? 0 : samplesSinceInput + numSamples;
+    sleeping = samplesSinceInput >= bakeLease.response->length;
+}
+
+/**
+ * PARALLEL mode: resonators do not interact, so each resonator channel can be processed independently.
+ * Resonators whose delay line is longer than the block are processed a whole block at a time;
+ * the loops of the remaining (short-delay) resonators are run in lockstep through the SIMD lane kernel,
+ * one lane per resonator channel.
+ * The post filters are then applied one resonator at a time over the whole block.
+ * Collapsed resonators (see StereoResonator::updateCollapse()) only process their left channel,
+ * whose post-processed output is copied to the right channel.
+ */
+void WaveguideResonatorBank::processParallel(juce::dsp::AudioBlock<float>& exciterBlock,
+                                             juce::dsp::AudioBlock<float>& previousResonatorBankBlock,
+                                             bool inputActive)
+{
+    const int numSamples = static_cast<int>(exciterBlock.getNumSamples());
+    mixInput(exciterBlock, previousResonatorBankBlock);
+
+    const float* inputs[2] = {inputBuffer.getReadPointer(0), inputBuffer.getReadPointer(1)};
+
+    laneKernel.clear();
+    for (int j = 0; j < NUM_RESONATORS; j++)
+    {
+        if (!resonators[j]->enabled) continue;
+        const int numChannels = resonators[j]->collapsed ? 1 : 2;
+        for (int c = 0; c < numChannels; c++)
+        {
+            auto& resonator = resonators[j]->resonators[c];
+            if (resonator.sleeping)
+            {
+                if (!inputActive)
+                {
+                    laneBuffer.clear(2 * j + c, 0, numSamples);
+                    continue;
+                }
+                resonator.wake();
+            }
+
+            if (resonator.passthrough || resonator.canProcessBlock(numSamples))
+            {
+                resonator.processBlock(inputs[c], laneBuffer.getWritePointer(2 * j + c), numSamples);
+            }
+            else
+            {
+                laneRows[static_cast<size_t>(laneKernel.getNumLanes())] = 2 * j + c;
+                laneKernel.addLane(resonator);
+            }
+        }
+    }
+
+    const int numLanes = laneKernel.getNumLanes();
+    if (numLanes > 0)
+    {
+        float* rows[BankLaneKernel::maxLanes];
+        const float* laneInputs[BankLaneKernel::maxLanes];
+        for (int l = 0; l < numLanes; l++)
+        {
+            rows[l] = laneBuffer.getWritePointer(laneRows[static_cast<size_t>(l)]);
+            laneInputs[l] = inputs[laneRows[static_cast<size_t>(l)] % 2];
+        }
+
+        float feedback[BankLaneKernel::maxLanes];
+        laneKernel.load();
+        for (int i = 0; i < numSamples; i++)
+        {
+            const float* out = laneKernel.popSamples();
+            for (int l = 0; l < numLanes; l++)
+            {
+                rows[l][i] = out[l];
+                feedback[l] = out[l] + laneInputs[l][i];
+            }
+            laneKernel.pushSamples(feedback);
+        }
+        laneKernel.store();
+    }
+
+    float* outL = previousResonatorBankBlock.getChannelPointer(0);
+    float* outR = previousResonatorBankBlock.getChannelPointer(1);
+    juce::FloatVectorOperations::clear(outL, numSamples);
+    juce::FloatVectorOperations::clear(outR, numSamples);
+    for (int j = 0; j < NUM_RESONATORS; j++)
+    {
+        if (!resonators[j]->enabled) continue;
+        for (int c = 0; c < 2; c++)
+        {
+            auto& resonator = resonators[j]->resonators[c];
+            if (c == 1 && resonators[j]->collapsed)
+            {
+                laneBuffer.copyFrom(2 * j + 1, 0, laneBuffer, 2 * j, 0, numSamples);
+                if (!resonators[j]->left.sleeping)
+                    juce::FloatVectorOperations::add(outR, laneBuffer.getReadPointer(2 * j), numSamples);
+                continue;
+            }
+            if (resonator.sleeping) continue; //the row is already silent
+            float* row = laneBuffer.getWritePointer(2 * j + c);
+            for (int i = 0; i < numSamples; i++)
+            {
+                row[i] = resonator.postProcess(row[i]) * resonator.gain;
+            }
+            juce::FloatVectorOperations::add(c == 0 ? outL : outR, row, numSamples);
+        }
+
+        if (state.soloActive &&
+            state.soloBankIndex == index &&
+            state.soloResonatorIndex == resonators[j]->resonatorIndex)
+        {
+            voice.soloBuffer.copyFrom(0, voice.currentBlockStartSample, laneBuffer, 2 * j, 0, numSamples);
+            voice.soloBuffer.copyFrom(1, voice.currentBlockStartSample, laneBuffer, 2 * j + 1, 0, numSamples);
+        }
+    }
+
+    juce::FloatVectorOperations::multiply(outL, outputGain / totalGainL, numSamples);
+    juce::FloatVectorOperations::multiply(outR, outputGain / totalGainR, numSamples);
+}
+
+/**
+ * Mixes the exciters and the previous bank into the bank's input, in inputBuffer.
+ */
+void WaveguideResonatorBank::mixInput(const juce::dsp::AudioBlock<float>& exciterBlock,
+                                      const juce::dsp::AudioBlock<float>& previousResonatorBankBlock)
+{
+    const int numSamples = static_cast<int>(exciterBlock.getNumSamples());
+    jassert(numSamples <= inputBuffer.getNumSamples());
+
+    for (int c = 0; c < 2; c++)
+    {
+        const float* exciter = exciterBlock.getChannelPointer(static_cast<size_t>(c));
+        const float* previous = previousResonatorBankBlock.getChannelPointer(static_cast<size_t>(c));
+        float* input = inputBuffer.getWritePointer(c);
+        for (int i = 0; i < numSamples; i++)
+        {
+            input[i] = (exciter[i] * exciterMix + previous[i] * previousResonatorBankMix) * inputGain;
+        }
+    }
+}
+
+/**
+ * Baked PARALLEL mode: the output is the input convolved with the bank's impulse response,
+ * which replaces the resonators, their post filters and gains; the normalisation and output gain are applied as usual.
+ */
+void WaveguideResonatorBank::processBaked(juce::dsp::AudioBlock<float>& exciterBlock,
+                                          juce::dsp::AudioBlock<float>& previousResonatorBankBlock)
+{
+    const int numSamples = static_cast<int>(exciterBlock.getNumSamples());
+    mixInput(exciterBlock, previousResonatorBankBlock);
+
+    float* outL = previousResonatorBankBlock.getChannelPointer(0);
+    float* outR = previousResonatorBankBlock.getChannelPointer(1);
+    convolvers[0].process(inputBuffer.getReadPointer(0), outL, numSamples);
+    convolvers[1].process(inputBuffer.getReadPointer(1), outR, numSamples);
+    juce::FloatVectorOperations::multiply(outL, outputGain / totalGainL, numSamples);
+    juce::FloatVectorOperations::multiply(outR, outputGain / totalGainR, numSamples);
+}
+
+/**
+ * Adds what is left of the convolution's output, after the bank was unbaked, to the live resonators' output.
+ */
+void WaveguideResonatorBank::addConvolutionTail(juce::dsp::AudioBlock<float>& previousResonatorBankBlock)
+{
+    const int numSamples = juce::jmin(static_cast<int>(previousResonatorBankBlock.getNumSamples()), convolutionTail);
+    for (int c = 0; c < 2; c++)
+    {
+        float* tail = inputBuffer.getWritePointer(c);
+        convolvers[c].process(nullptr, tail, numSamples);
+        juce::FloatVectorOperations::addWithMultiply(previousResonatorBankBlock.getChannelPointer(static_cast<size_t>(c)),
+                                                     tail, outputGain / (c == 0 ? totalGainL : totalGainR),
+                                                     numSamples);
+    }
+    convolutionTail -= numSamples;
+    if (convolutionTail == 0) releaseBake();
 }
 
 void WaveguideResonatorBank::setFeedbackMode(CouplingMode newMode)
@@ -4,6 +4,10 @@
 #include "GlobalState.h"
 #include "ResonatorBank.h"
 #include "StereoResonator.h"
+#include "ResonatorLaneKernel.h"
+#include "ImpulseResponseBaker.h"
+#include "dsp/PartitionedConvolver.h"
+#include "util/InlineArray.h"
 
 class ResonatorVoice;
 /**
@@ -24,26 +28,89 @@ public:
     void process(
         juce::dsp::AudioBlock<float>& exciterBlock,
         juce::dsp::AudioBlock <float>& previousResonatorBankBlock);
+    bool beginProcess(
+        juce::dsp::AudioBlock<float>& exciterBlock,
+        juce::dsp::AudioBlock<float>& previousResonatorBankBlock,
+        bool& inputActive);
     void reset();
+    void addModParameters(ModValueTable& table);
     void prepare(const juce::dsp::ProcessSpec& spec);
     void updateParameters(float newFrequency, int numSamples);
     void setFeedbackMode(CouplingMode newMode);
+    void processParallel(
+        juce::dsp::AudioBlock<float>& exciterBlock,
+        juce::dsp::AudioBlock<float>& previousResonatorBankBlock,
+        bool inputActive);
+    void processBaked(
+        juce::dsp::AudioBlock<float>& exciterBlock,
+        juce::dsp::AudioBlock<float>& previousResonatorBankBlock);
+    void mixInput(
+        const juce::dsp::AudioBlock<float>& exciterBlock,
+        const juce::dsp::AudioBlock<float>& previousResonatorBankBlock);
+    float getInputPeak(
+        const juce::dsp::AudioBlock<float>& exciterBlock,
+        const juce::dsp::AudioBlock<float>& previousResonatorBankBlock) const;
+    void updateActivity(int numSamples, bool inputActive);
+    void updateBakedActivity(int numSamples, bool inputActive);
+    static bool channelsAreIdentical(const juce::dsp::AudioBlock<float>& block);
+
+    /**
+     * Whether this bank's output depends on the previous bank's output during the current block,
+     * i.e. whether it mixes the previous bank in, or passes it through unprocessed because all of its gains are zero.
+     * Banks that do not can be processed concurrently with the banks before them.
+     */
+    bool readsPreviousBank() const;
+
+    /**
+     * Whether the bank is a linear time-invariant system that can be replaced by its impulse response:
+     * baking is enabled, the bank is in PARALLEL mode, and none of its enabled resonators are modulated
+     * or keytracked, so that neither modulation nor bending the note can change it while it plays.
+     */
+    bool canBake() const;
+    void startBake();
+    void releaseBake();
+    void updateBake(bool resonatorsChanged, int numSamples);
+    void addConvolutionTail(juce::dsp::AudioBlock<float>& previousResonatorBankBlock);
 
-    GlobalState& state;
-    ResonatorVoice& voice;
-    WaveguideResonatorBankParams params;
     int index = -1;
     CouplingMode couplingMode = PARALLEL;
     float frequency = 44100.0f;
     float sampleRate = 440.0f;
-    juce::OwnedArray<StereoResonator> resonators;
+    InlineArray<StereoResonator, NUM_RESONATORS> resonators; //constructed in place, inside the bank
 
     float previousResonatorBankMix = 0.0f; //how much of the previous resonator bank's output should we mix in?
     float exciterMix = 1.0f; //how much of the exciter signal should we mix in?
     float inputGain = 1.0f;
     float outputGain = 1.0f;
 
+    //the sum of the resonator gains of each channel, used to normalize the output
+    float totalGainL = 0.0f;
+    float totalGainR = 0.0f;
+
+    //true once every enabled resonator has decayed below the silence threshold and the bank has no input;
+    //a sleeping bank outputs silence without processing its resonators
+    bool sleeping = false;
+
+    //below is for parallel mode
+    BankLaneKernel laneKernel;
+    std::array<int, BankLaneKernel::maxLanes> laneRows; //the laneBuffer channel that each kernel lane writes to
+    juce::AudioBuffer<float> inputBuffer; //the bank's input, i.e. the mix of the exciter and the previous bank
+    juce::AudioBuffer<float> laneBuffer; //one channel per resonator channel; channel 2 * j + c is resonator j, channel c
+
+    //below is for baked parallel mode, see ImpulseResponseBaker
+    ImpulseResponseBaker::Lease bakeLease; //the impulse response in use, while baked or playing out its tail
+    float* convolutionState = nullptr; //both channels' convolver state, from the baker
+    PartitionedConvolver convolvers[2];
+    bool baked = false; //the convolvers stand in for the resonators
+    ImpulseResponseBaker::Key bakedKey = 0; //the key of bakeLease's response, while baked
+    bool bakeCandidate = false; //set on reset; the impulse response is looked up at the first update of the note
+    int convolutionTail = 0; //samples left of the convolution's output, after the resonators have taken over again
+    int samplesSinceInput = 0;
+    juce::uint32 enabledResonators = 0; //one bit per enabled resonator, at the last update
+
     //below is for cascade mode
+    float cascadeAmountL = 0.0f;
+    float cascadeAmountR = 0.0f;
     juce::dsp::IIR::Coefficients<float>::Ptr dcBlockerCoefficients;
     juce::dsp::IIR::Filter <float> dcBlockersL[NUM_RESONATORS];
     juce::dsp::IIR::Filter <float> dcBlockersR[NUM_RESONATORS];
@@ -52,6 +119,17 @@ public:
 
     chowdsp::SVFMultiMode<float, NUM_RESONATORS, true> testInterlinkedFilterL;
     chowdsp::SVFMultiMode<float, NUM_RESONATORS, true> testInterlinkedFilterR;
+
+    //cold: only read when parameters are updated, kept clear of the resonators
+    ResonatorCoefficientBatch coefficientBatch;
+    struct
+    {
+        ModValueTable::Handle couplingMode, inputGain, inputMix, outputGain,
+            cascadeLevel, cascadeFilterCutoff, cascadeFilterResonance, cascadeFilterMode;
+    } modHandles {}; //where the parameters are read from, in the voice's ModValueTable
+    GlobalState& state;
+    ResonatorVoice& voice;
+    WaveguideResonatorBankParams params;
 };
 
 #endif //WAVEGUIDERESONATORBANK_H
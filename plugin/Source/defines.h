@@ -10,6 +10,7 @@
 #endif
 
 #define NUM_SYNTH_VOICES 16
+#define VOICE_GROUP_SIZE 4 //the most voices whose coupled resonator banks are rendered together, see VoiceGroupRenderer
 
 //resonators
 #define NUM_RESONATORS 8
@@ -17,8 +18,10 @@
 
 //parameter values
 #define MIN_FILTER_FREQUENCY 10.0f
+#define MIN_RESONATOR_FREQUENCY 10.0f //resonators are never tuned lower than this; sizes their delay lines
 #define MAX_FILTER_FREQUENCY 20000.0f
 #define FREQUENCY_KNOB_SKEW 0.3f
+#define PARAMETER_SMOOTHING_TIME 0.02 //seconds; the mod matrix glides every parameter to its new value over this long
 
 //exciters
 #define NUM_IMPULSE_EXCITERS 1
@@ -0,0 +1,31 @@
+#include "DelayLineArena.h"
+
+float* DelayLineArena::allocate(size_t numFloats)
+{
+    numFloats = (numFloats + alignmentInFloats - 1) / alignmentInFloats * alignmentInFloats;
+    if (chunkStart == nullptr || chunkUsed + numFloats > chunkSize)
+    {
+        //the tail of the current chunk is abandoned; the chunk itself stays alive until clear()
+        chunkSize = juce::jmax(minimumChunkSize, numFloats);
+        juce::HeapBlock<float> chunk(chunkSize + alignmentInFloats, true);
+        const auto address = reinterpret_cast<std::uintptr_t>(chunk.get());
+        const auto alignment = alignmentInFloats * sizeof(float);
+        chunkStart = reinterpret_cast<float*>((address + alignment - 1) / alignment * alignment);
+        chunkUsed = 0;
+        chunks.push_back(std::move(chunk));
+    }
+
+    float* storage = chunkStart + chunkUsed;
+    chunkUsed += numFloats;
+    numFloatsAllocated += numFloats;
+    return storage;
+}
+
+void DelayLineArena::clear()
+{
+    chunks.clear();
+    chunkStart = nullptr;
+    chunkSize = 0;
+    chunkUsed = 0;
+    numFloatsAllocated = 0;
+}
@@ -0,0 +1,39 @@
+#ifndef DELAYLINEARENA_H
+#define DELAYLINEARENA_H
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Backing storage for the resonator delay lines of a plugin instance.
+ *
+ * Memory is bump-allocated out of large zeroed chunks. Chunks are never moved or freed until clear(),
+ * so a pointer returned by allocate() stays valid, and can be handed to a delay line, until then.
+ * The arena only ever grows: allocate() and clear() must be called off the audio thread.
+ */
+class DelayLineArena
+{
+public:
+    /**
+     * Returns numFloats contiguous, zeroed floats, aligned to a cache line.
+     */
+    float* allocate(size_t numFloats);
+
+    /**
+     * Frees every chunk. Every pointer handed out so far becomes invalid.
+     */
+    void clear();
+
+    size_t getNumBytesAllocated() const noexcept { return numFloatsAllocated * sizeof(float); }
+
+private:
+    static constexpr size_t alignmentInFloats = 16; //64 bytes
+    static constexpr size_t minimumChunkSize = 1 << 20; //in floats, i.e. 4 MB
+
+    std::vector<juce::HeapBlock<float>> chunks;
+    float* chunkStart = nullptr;
+    size_t chunkSize = 0;
+    size_t chunkUsed = 0;
+    size_t numFloatsAllocated = 0;
+};
+
+#endif //DELAYLINEARENA_H
@@ -0,0 +1,84 @@
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <chowdsp_dsp_utils/chowdsp_dsp_utils.h>
+
+/**
+ * Polynomial approximations of the transcendental functions used to compute filter and resonator coefficients,
+ * on whole xsimd batches at once.
+ *
+ * Each one is only valid over the range documented on it, which is all that the coefficient computations need.
+ * Over that range, exp2, sin and cos are accurate to about 2e-7 and tan to about 4e-6 (relative),
+ * far below the smallest audible detuning (one cent is a relative frequency error of about 6e-4).
+ */
+namespace FastMath
+{
+    using Batch = xsimd::batch<float>;
+    using IntBatch = xsimd::batch<int32_t>;
+
+    /**
+     * 2^x, for -126 <= x <= 126 (x is clamped to that range).
+     */
+    inline Batch exp2(Batch x) noexcept
+    {
+        x = xsimd::clip(x, Batch(-126.0f), Batch(126.0f));
+        const IntBatch n = xsimd::nearbyint_as_int(x);
+        const Batch f = x - xsimd::to_float(n); //in [-0.5, 0.5]
+
+        //Taylor series of e^(f * ln 2), to the 7th power
+        Batch p(1.5252733804059840e-5f);
+        p = xsimd::fma(p, f, Batch(1.5403530393381610e-4f));
+        p = xsimd::fma(p, f, Batch(1.3333558146428443e-3f));
+        p = xsimd::fma(p, f, Batch(9.6181291076284772e-3f));
+        p = xsimd::fma(p, f, Batch(5.5504108664821580e-2f));
+        p = xsimd::fma(p, f, Batch(2.4022650695910071e-1f));
+        p = xsimd::fma(p, f, Batch(6.9314718055994531e-1f));
+        p = xsimd::fma(p, f, Batch(1.0f));
+
+        //2^n, built directly from its exponent bits
+        const Batch scale = xsimd::bitwise_cast<float>((n + IntBatch(127)) << 23);
+        return p * scale;
+    }
+
+    /**
+     * sin(x), for -pi/2 <= x <= pi/2.
+     */
+    inline Batch sin(Batch x) noexcept
+    {
+        const Batch x2 = x * x;
+        Batch p(-2.5052108385441720e-8f);
+        p = xsimd::fma(p, x2, Batch(2.7557319223985893e-6f));
+        p = xsimd::fma(p, x2, Batch(-1.9841269841269841e-4f));
+        p = xsimd::fma(p, x2, Batch(8.3333333333333333e-3f));
+        p = xsimd::fma(p, x2, Batch(-1.6666666666666667e-1f));
+        p = xsimd::fma(p, x2, Batch(1.0f));
+        return p * x;
+    }
+
+    /**
+     * cos(x), for -pi/2 <= x <= pi/2.
+     */
+    inline Batch cos(Batch x) noexcept
+    {
+        const Batch x2 = x * x;
+        Batch p(2.0876756987868099e-9f);
+        p = xsimd::fma(p, x2, Batch(-2.7557319223985891e-7f));
+        p = xsimd::fma(p, x2, Batch(2.4801587301587302e-5f));
+        p = xsimd::fma(p, x2, Batch(-1.3888888888888889e-3f));
+        p = xsimd::fma(p, x2, Batch(4.1666666666666667e-2f));
+        p = xsimd::fma(p, x2, Batch(-0.5f));
+        p = xsimd::fma(p, x2, Batch(1.0f));
+        return p;
+    }
+
+    /**
+     * tan(x), for 0 <= x <= 0.49 * pi, i.e. the bilinear transform prewarp tan(pi * cutoff / sampleRate)
+     * of any cutoff up to 0.49 times the sample rate.
+     */
+    inline Batch tan(Batch x) noexcept
+    {
+        return sin(x) / cos(x);
+    }
+}
+
+#endif //FASTMATH_H
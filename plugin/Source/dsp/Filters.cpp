@@ -12,6 +12,19 @@ float DispersionFilter::processSample(float input)
     return output;
 }
 
+void DispersionFilter::processBlock(float* samples, int numSamples)
+{
+    float z = state[1];
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float input = samples[i];
+        samples[i] = s * input + c * z;
+        z = c * input - s * z;
+    }
+    state[0] = z;
+    state[1] = z;
+}
+
 void DispersionFilter::prepare(juce::dsp::ProcessSpec spec)
 {
     reset();
@@ -37,6 +50,12 @@ void DispersionFilter::setDispersionAmount(float amount)
     // s = - amount;
 }
 
+void DispersionFilter::setCoefficients(float newC, float newS)
+{
+    c = newC;
+    s = newS;
+}
+
 float OneZeroFilter::processSample(float input)
 {
     const float output = (1 - p) * input + p * state;
@@ -59,5 +78,80 @@ void OneZeroFilter::setBrightness(float brightness)
     this->p = brightness;
 }
 
+float WaveguideLoopFilter::processSample(float input)
+{
+    const float v3 = input - ic2eq;
+    const float v1 = a1 * ic1eq + a2 * v3;
+    const float v2 = ic2eq + a2 * ic1eq + a3 * v3;
+    ic1eq = 2.0f * v1 - ic1eq;
+    ic2eq = 2.0f * v2 - ic2eq;
+    return lowpassMult * v2 + bandpassMult * v1 + highpassMult * (input - k * v1 - v2);
+}
 
+void WaveguideLoopFilter::processBlock(float* samples, int numSamples)
+{
+    //keep the state in locals so that it stays in registers for the whole block
+    float s1 = ic1eq;
+    float s2 = ic2eq;
+    for (int i = 0; i < numSamples; i++)
+    {
+        const float input = samples[i];
+        const float v3 = input - s2;
+        const float v1 = a1 * s1 + a2 * v3;
+        const float v2 = s2 + a2 * s1 + a3 * v3;
+        s1 = 2.0f * v1 - s1;
+        s2 = 2.0f * v2 - s2;
+        samples[i] = lowpassMult * v2 + bandpassMult * v1 + highpassMult * (input - k * v1 - v2);
+    }
+    ic1eq = s1;
+    ic2eq = s2;
+}
 
+void WaveguideLoopFilter::prepare(juce::dsp::ProcessSpec spec)
+{
+    sampleRate = static_cast<float>(spec.sampleRate);
+    cutoff = -1.0f; //force a coefficient update
+    reset();
+}
+
+void WaveguideLoopFilter::reset()
+{
+    ic1eq = 0;
+    ic2eq = 0;
+}
+
+void WaveguideLoopFilter::snapToZero() noexcept
+{
+    juce::dsp::util::snapToZero(ic1eq);
+    juce::dsp::util::snapToZero(ic2eq);
+}
+
+bool WaveguideLoopFilter::setParameters(float newCutoff, float newQ, float newMode)
+{
+    if (newCutoff == cutoff && newQ == q && newMode == mode)
+        return false;
+
+    const float clampedCutoff = juce::jlimit(1.0f, sampleRate * 0.49f, newCutoff);
+    return setParameters(newCutoff, newQ, newMode, std::tan(juce::MathConstants<float>::pi * clampedCutoff / sampleRate));
+}
+
+bool WaveguideLoopFilter::setParameters(float newCutoff, float newQ, float newMode, float prewarpedCutoff)
+{
+    if (newCutoff == cutoff && newQ == q && newMode == mode)
+        return false;
+
+    cutoff = newCutoff;
+    q = newQ;
+    mode = newMode;
+
+    const float g = prewarpedCutoff;
+    k = 1.0f / q;
+    a1 = 1.0f / (1.0f + g * (g + k));
+    a2 = g * a1;
+    a3 = g * a2;
+
+    lowpassMult = mode < 0.25f ? 1.0f : 0.0f;
+    bandpassMult = mode >= 0.25f && mode <= 0.75f ? k : 0.0f; //bandpass is normalized to unity gain at the peak
+    highpassMult = mode > 0.75f ? 1.0f : 0.0f;
+    return true;
+}
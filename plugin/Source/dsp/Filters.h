@@ -11,9 +11,14 @@ class DispersionFilter
 {
 public:
     float processSample(float input);
+    void processBlock(float* samples, int numSamples);
     void prepare(juce::dsp::ProcessSpec spec);
     void reset();
     void setDispersionAmount(float amount);
+    /**
+     * Sets the coefficients directly, i.e. cos and sin of the angle that setDispersionAmount() would compute.
+     */
+    void setCoefficients(float newC, float newS);
 
     float state[2] = {0, 0};
     float c = 1.0f;
@@ -38,4 +43,47 @@ public:
     float p = 0.5;
 };
 
+/**
+ * The state variable filter that sits inside a resonator's waveguide loop.
+ * A TPT (topology-preserving transform) SVF that selects between lowpass, (unity-peak) bandpass and highpass,
+ * mirroring chowdsp::SVFMultiMode at its three discrete modes.
+ * Coefficients and state are public so that the resonator bank can load them into its SIMD lanes.
+ */
+class WaveguideLoopFilter
+{
+public:
+    float processSample(float input);
+    void processBlock(float* samples, int numSamples);
+    void prepare(juce::dsp::ProcessSpec spec);
+    void reset();
+
+    /**
+     * Updates the filter coefficients. Mode is 0 for lowpass, 0.5 for bandpass and 1 for highpass.
+     * @return true if the coefficients changed.
+     */
+    bool setParameters(float cutoff, float q, float mode);
+    /**
+     * As above, with the prewarped cutoff tan(pi * cutoff / sampleRate) already computed by the caller,
+     * with the cutoff clamped to [1, 0.49 * sampleRate].
+     */
+    bool setParameters(float cutoff, float q, float mode, float prewarpedCutoff);
+    void snapToZero() noexcept;
+
+    float sampleRate = 44100.0f;
+    float cutoff = -1.0f;
+    float q = -1.0f;
+    float mode = -1.0f;
+
+    float k = 1.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+    float a3 = 0.0f;
+    float lowpassMult = 1.0f;
+    float bandpassMult = 0.0f;
+    float highpassMult = 0.0f;
+
+    float ic1eq = 0.0f;
+    float ic2eq = 0.0f;
+};
+
 #endif //FILTERS_H
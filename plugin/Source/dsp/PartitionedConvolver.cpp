@@ -0,0 +1,201 @@
+#include "PartitionedConvolver.h"
+
+PartitionedConvolver::ImpulseResponse::ImpulseResponse(const float* samples, int length, int firstBlockSize) :
+    layout(makeLayout(length, firstBlockSize)),
+    length(length)
+{
+    jassert(juce::isPowerOfTwo(firstBlockSize));
+    jassert(firstBlockSize >= minFirstBlockSize && firstBlockSize <= maxFirstBlockSize);
+
+    for (const auto& stage : layout.stages)
+    {
+        const int blockSize = stage.blockSize;
+        const int binFloats = 2 * (blockSize + 1);
+        ffts.push_back(std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * blockSize))));
+
+        std::vector<float> spectra(static_cast<size_t>(stage.numPartitions * binFloats));
+        std::vector<float> buffer(static_cast<size_t>(4 * blockSize));
+        for (int p = 0; p < stage.numPartitions; p++)
+        {
+            //each partition is zero-padded to the FFT size
+            std::fill(buffer.begin(), buffer.end(), 0.0f);
+            const int start = stage.offset + p * blockSize;
+            const int end = juce::jmin(start + blockSize, length);
+            for (int i = start; i < end; i++)
+            {
+                buffer[static_cast<size_t>(i - start)] = samples[i];
+            }
+            ffts.back()->performRealOnlyForwardTransform(buffer.data(), true);
+            std::copy(buffer.begin(), buffer.begin() + binFloats, spectra.begin() + p * binFloats);
+        }
+        partitionSpectra.push_back(std::move(spectra));
+    }
+}
+
+size_t PartitionedConvolver::ImpulseResponse::getMaxStateSize(int maxLength)
+{
+    size_t maxStateSize = 0;
+    for (int firstBlockSize = minFirstBlockSize; firstBlockSize <= maxFirstBlockSize; firstBlockSize *= 2)
+    {
+        maxStateSize = juce::jmax(maxStateSize, makeLayout(maxLength, firstBlockSize).stateSize);
+    }
+    return maxStateSize;
+}
+
+/**
+ * Two partitions per block size, doubling the block size at every stage. A stage outputs a block one block size
+ * after its input, so it can only cover the impulse response from one block size on; since every stage starts
+ * where the previous one ends, at no less than twice the previous block size, this always holds.
+ * The state is laid out as: the output accumulator, the FFT scratch space, then the input windows and spectra of each stage.
+ */
+PartitionedConvolver::ImpulseResponse::Layout PartitionedConvolver::ImpulseResponse::makeLayout(int length,
+                                                                                                 int firstBlockSize)
+{
+    Layout layout;
+    int offset = firstBlockSize;
+    int blockSize = firstBlockSize;
+    int furthestOutput = 0;
+    while (offset < length)
+    {
+        Stage stage;
+        stage.blockSize = blockSize;
+        stage.offset = offset;
+        const int remaining = length - offset;
+        const bool last = blockSize == maxBlockSize || remaining <= 2 * blockSize
+            || static_cast<int>(layout.stages.size()) == maxNumStages - 1;
+        stage.numPartitions = last ? (remaining + blockSize - 1) / blockSize : 2;
+        layout.stages.push_back(stage);
+
+        furthestOutput = juce::jmax(furthestOutput, offset + blockSize);
+        offset += stage.numPartitions * blockSize;
+        blockSize = juce::jmin(2 * blockSize, maxBlockSize);
+    }
+
+    layout.ringSize = juce::nextPowerOfTwo(juce::jmax(furthestOutput + 1, firstBlockSize));
+    layout.scratchOffset = static_cast<size_t>(layout.ringSize);
+    size_t position = layout.scratchOffset + static_cast<size_t>(4 * (layout.stages.empty()
+                                                                          ? 0
+                                                                          : layout.stages.back().blockSize));
+    for (auto& stage : layout.stages)
+    {
+        stage.windowOffset = position;
+        position += static_cast<size_t>(2 * stage.blockSize);
+        stage.spectraOffset = position;
+        position += static_cast<size_t>(stage.numPartitions * 2 * (stage.blockSize + 1));
+    }
+    layout.stateSize = position;
+    return layout;
+}
+
+void PartitionedConvolver::reset(const ImpulseResponse& impulseResponse, float* memory) noexcept
+{
+    response = &impulseResponse;
+    state = memory;
+    time = 0;
+    newestSpectrum.fill(0);
+    std::fill(state, state + response->getStateSize(), 0.0f);
+}
+
+void PartitionedConvolver::process(const float* input, float* output, int numSamples) noexcept
+{
+    jassert(response != nullptr);
+    const auto& layout = response->layout;
+    if (layout.stages.empty())
+    {
+        //nothing past the leading zeros
+        juce::FloatVectorOperations::clear(output, numSamples);
+        return;
+    }
+
+    //the input is taken in chunks that never cross a block boundary of the first (smallest) stage,
+    //and therefore of any stage, since the block sizes are multiples of each other
+    const auto firstBlockSize = static_cast<juce::uint32>(layout.stages.front().blockSize);
+    const auto ringMask = static_cast<juce::uint32>(layout.ringSize - 1);
+    int i = 0;
+    while (i < numSamples)
+    {
+        const int chunk = juce::jmin(numSamples - i, static_cast<int>(firstBlockSize - (time & (firstBlockSize - 1))));
+
+        for (const auto& stage : layout.stages)
+        {
+            float* window = state + stage.windowOffset + stage.blockSize
+                + (time & static_cast<juce::uint32>(stage.blockSize - 1));
+            if (input != nullptr)
+                juce::FloatVectorOperations::copy(window, input + i, chunk);
+            else
+                juce::FloatVectorOperations::clear(window, chunk);
+        }
+
+        float* ring = state + (time & ringMask);
+        juce::FloatVectorOperations::copy(output + i, ring, chunk);
+        juce::FloatVectorOperations::clear(ring, chunk);
+
+        time += static_cast<juce::uint32>(chunk);
+        i += chunk;
+        for (size_t s = 0; s < layout.stages.size(); s++)
+        {
+            if ((time & static_cast<juce::uint32>(layout.stages[s].blockSize - 1)) == 0)
+            {
+                processStage(s, time);
+            }
+        }
+    }
+}
+
+/**
+ * Runs one block of a stage, once its input block [blockEnd - blockSize, blockEnd) is complete:
+ * transforms the block, multiplies the spectra of the last numPartitions blocks with those of the partitions,
+ * and adds the result to the output accumulator, at its place in the future.
+ */
+void PartitionedConvolver::processStage(size_t stageIndex, juce::uint32 blockEnd) noexcept
+{
+    const auto& layout = response->layout;
+    const auto& stage = layout.stages[stageIndex];
+    const auto& fft = *response->ffts[stageIndex];
+    const int blockSize = stage.blockSize;
+    const int numPartitions = stage.numPartitions;
+    const int binFloats = 2 * (blockSize + 1);
+    float* window = state + stage.windowOffset;
+    float* spectra = state + stage.spectraOffset;
+    float* scratch = state + layout.scratchOffset;
+
+    //overlap-save: the FFT of the last two input blocks
+    juce::FloatVectorOperations::copy(scratch, window, 2 * blockSize);
+    juce::FloatVectorOperations::clear(scratch + 2 * blockSize, 2 * blockSize);
+    fft.performRealOnlyForwardTransform(scratch, true);
+    auto& newest = newestSpectrum[stageIndex];
+    newest = (newest + numPartitions - 1) % numPartitions;
+    juce::FloatVectorOperations::copy(spectra + newest * binFloats, scratch, binFloats);
+    juce::FloatVectorOperations::copy(window, window + blockSize, blockSize);
+
+    //partition p of the impulse response is applied to the input block from p blocks ago
+    juce::FloatVectorOperations::clear(scratch, 4 * blockSize);
+    const float* partitions = response->partitionSpectra[stageIndex].data();
+    for (int p = 0; p < numPartitions; p++)
+    {
+        const float* x = spectra + ((newest + p) % numPartitions) * binFloats;
+        const float* h = partitions + p * binFloats;
+        for (int k = 0; k < binFloats; k += 2)
+        {
+            scratch[k] += x[k] * h[k] - x[k + 1] * h[k + 1];
+            scratch[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+        }
+    }
+
+    //the spectrum of a real signal is conjugate-symmetric
+    const int fftSize = 2 * blockSize;
+    for (int k = 1; k < blockSize; k++)
+    {
+        scratch[2 * (fftSize - k)] = scratch[2 * k];
+        scratch[2 * (fftSize - k) + 1] = -scratch[2 * k + 1];
+    }
+    fft.performRealOnlyInverseTransform(scratch);
+
+    //the second half is the linear convolution of the block; its sample m belongs at m + offset
+    const auto ringMask = static_cast<juce::uint32>(layout.ringSize - 1);
+    const juce::uint32 start = blockEnd - static_cast<juce::uint32>(blockSize) + static_cast<juce::uint32>(stage.offset);
+    for (int i = 0; i < blockSize; i++)
+    {
+        state[(start + static_cast<juce::uint32>(i)) & ringMask] += scratch[blockSize + i];
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef PARTITIONEDCONVOLVER_H
+#define PARTITIONEDCONVOLVER_H
+
+#include <juce_dsp/juce_dsp.h>
+
+/**
+ * Non-uniformly partitioned FFT convolution of a single channel with a fixed impulse response, without latency.
+ *
+ * The impulse response is split into stages of growing block size (Gardner's scheme): two partitions of the smallest
+ * block size, two of twice that size, and so on up to maxBlockSize, which takes whatever remains.
+ * Each stage is a uniformly partitioned overlap-save convolution that runs once per block of its own size,
+ * so the cost per sample grows with the logarithm of the impulse response's length instead of linearly.
+ *
+ * A stage only has its output once its input block is complete, i.e. one block size later. The convolver therefore
+ * only takes impulse responses that start with at least firstBlockSize zeros, which it skips. This holds for the
+ * output of a waveguide, which stays silent for a whole trip around its delay line. With that, the output is
+ * exactly that of direct convolution, with no added latency.
+ *
+ * The ImpulseResponse is immutable once built, and can be shared by any number of convolvers.
+ * Each convolver keeps only its own state, in memory handed to it by the caller, so it never allocates.
+ */
+class PartitionedConvolver
+{
+public:
+    static constexpr int minFirstBlockSize = 16;
+    static constexpr int maxFirstBlockSize = 256;
+    //the tail partition: long, slowly decaying responses spend most of their length here,
+    //at a cost per sample that hardly grows with the partition size
+    static constexpr int maxBlockSize = 16384;
+    static constexpr int maxNumStages = 12; //enough to reach maxBlockSize from minFirstBlockSize
+
+    class ImpulseResponse
+    {
+    public:
+        /**
+         * Partitions and transforms an impulse response. Allocates, so it must be built off the audio thread.
+         * @param firstBlockSize a power of two between minFirstBlockSize and maxFirstBlockSize;
+         * samples[0, firstBlockSize) must all be zero.
+         */
+        ImpulseResponse(const float* samples, int length, int firstBlockSize);
+
+        int getLength() const noexcept { return length; }
+
+        /**
+         * The number of floats of state that a convolver needs for this impulse response.
+         */
+        size_t getStateSize() const noexcept { return layout.stateSize; }
+
+        /**
+         * The largest getStateSize() of any impulse response of up to maxLength samples.
+         */
+        static size_t getMaxStateSize(int maxLength);
+
+    private:
+        friend class PartitionedConvolver;
+
+        struct Stage
+        {
+            int blockSize = 0; //the FFT size is twice this
+            int offset = 0; //the first sample of the impulse response that the stage convolves with
+            int numPartitions = 0;
+            size_t windowOffset = 0; //where the stage's last two input blocks are kept, in the convolver's state
+            size_t spectraOffset = 0; //where the spectra of the stage's past input blocks are kept
+        };
+
+        struct Layout
+        {
+            std::vector<Stage> stages;
+            int ringSize = 0; //the size of the output accumulator, a power of two
+            size_t scratchOffset = 0;
+            size_t stateSize = 0;
+        };
+
+        static Layout makeLayout(int length, int firstBlockSize);
+
+        Layout layout;
+        int length = 0;
+        std::vector<std::unique_ptr<juce::dsp::FFT>> ffts; //one per stage
+        std::vector<std::vector<float>> partitionSpectra; //per stage, numPartitions spectra of blockSize + 1 bins
+    };
+
+    /**
+     * Starts convolving with the given impulse response, from silence.
+     * memory must hold impulseResponse.getStateSize() floats, and it and the impulse response must outlive the
+     * convolver's use of them. Does not allocate.
+     */
+    void reset(const ImpulseResponse& impulseResponse, float* memory) noexcept;
+
+    /**
+     * Convolves a block. input may be nullptr, for silence; input and output may be the same.
+     */
+    void process(const float* input, float* output, int numSamples) noexcept;
+
+private:
+    void processStage(size_t stageIndex, juce::uint32 blockEnd) noexcept;
+
+    const ImpulseResponse* response = nullptr;
+    float* state = nullptr;
+    juce::uint32 time = 0; //the number of samples processed; wraps, which is harmless as every size is a power of two
+    std::array<int, maxNumStages> newestSpectrum {}; //per stage, the slot of the most recent input block's spectrum
+};
+
+#endif //PARTITIONEDCONVOLVER_H
@@ -2,6 +2,7 @@
 
 #include "../ResonatorVoice.h"
 #include "../defines.h"
+#include <melatonin_perfetto/melatonin_perfetto.h>
 
 ResonariumEffectChain::ResonariumEffectChain(EffectChainParams params)
     : chorusParams(params.chorusParams),
@@ -44,6 +45,7 @@ void ResonariumEffectChain::reset()
     filter1.reset();
     filter2.reset();
     phaser.reset();
+    compressor.reset();
     mverb.reset();
     gain.reset();
     distortion.reset();
@@ -150,20 +152,34 @@ void ResonariumEffectChain::updateParameters(T& source, juce::AudioPlayHead* pla
 
 void ResonariumEffectChain::process(juce::dsp::AudioBlock<float> block) noexcept
 {
+    TRACE_DSP();
     const juce::dsp::ProcessContextReplacing context(block);
-    if (filter1Params.enabled->isOn()) filter1.process(context);
-    if (chorusParams.enabled->isOn()) chorus.process(context);
-    if (phaserParams.enabled->isOn()) phaser.process(context);
-    if (distortionParams.enabled->isOn()) distortion.process(context);
-    if (multiAmpParams.enabled->isOn()) multiAmp.process(context);
-    if (delayParams.enabled->isOn()) delay.process(context);
-    if (compressorParams.enabled->isOn()) compressor.process(context);
+    //each effect is traced and timed as a stage of its own
+    auto runStage = [this](StageProfiler::Stage stage, auto&& processEffect)
+    {
+#if PERFETTO
+        //named after the effect, rather than this lambda, so that each effect has its own track on the timeline
+        TRACE_EVENT("dsp", perfetto::DynamicString(StageProfiler::getStageName(stage)));
+#endif
+        StageProfiler::ScopedStage scopedStage(profiler, stage);
+        processEffect();
+    };
+    if (filter1Params.enabled->isOn()) runStage(StageProfiler::filter1, [&] { filter1.process(context); });
+    if (chorusParams.enabled->isOn()) runStage(StageProfiler::chorus, [&] { chorus.process(context); });
+    if (phaserParams.enabled->isOn()) runStage(StageProfiler::phaser, [&] { phaser.process(context); });
+    if (distortionParams.enabled->isOn()) runStage(StageProfiler::distortion, [&] { distortion.process(context); });
+    if (multiAmpParams.enabled->isOn()) runStage(StageProfiler::multiAmp, [&] { multiAmp.process(context); });
+    if (delayParams.enabled->isOn()) runStage(StageProfiler::delay, [&] { delay.process(context); });
+    if (compressorParams.enabled->isOn()) runStage(StageProfiler::compressor, [&] { compressor.process(context); });
     if (reverbParams.enabled->isOn())
     {
-        float* data[2] = {block.getChannelPointer(0), block.getChannelPointer(1)};
-        mverb.process(data, data, block.getNumSamples());
+        runStage(StageProfiler::reverb, [&]
+        {
+            float* data[2] = {block.getChannelPointer(0), block.getChannelPointer(1)};
+            mverb.process(data, data, block.getNumSamples());
+        });
     }
-    if (filter2Params.enabled->isOn()) filter2.process(context);
+    if (filter2Params.enabled->isOn()) runStage(StageProfiler::filter2, [&] { filter2.process(context); });
 }
 
 
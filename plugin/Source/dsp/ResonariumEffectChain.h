@@ -6,6 +6,7 @@
 #include "MultiDelay.h"
 #include "MVerb.h"
 #include "WrappedSVF.h"
+#include "../util/StageProfiler.h"
 
 class ResonariumEffectChain
 {
@@ -22,6 +23,7 @@ public:
     void process(juce::dsp::AudioBlock<float> block) noexcept;
 
     int channel = 0;
+    StageProfiler* profiler = nullptr; //set by the owner; times each effect if not null
 
     juce::dsp::Chorus<float> chorus;
     ChorusParams chorusParams;
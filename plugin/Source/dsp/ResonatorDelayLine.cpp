@@ -0,0 +1,109 @@
+#include "ResonatorDelayLine.h"
+
+void ResonatorDelayLine::setMaximumDelayInSamples(int maximumDelayInSamples)
+{
+    jassert(maximumDelayInSamples >= 1);
+    //the interpolator reads up to two samples beyond the integer delay, plus the tap at the write head
+    totalSize = juce::jmax(4, maximumDelayInSamples + 3);
+    maximumDelay = static_cast<float>(totalSize - 3);
+    buffer = nullptr;
+    writePos = 0;
+    delay = juce::jmin(delay, maximumDelay);
+}
+
+void ResonatorDelayLine::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    juce::ignoreUnused(spec);
+    reset();
+}
+
+void ResonatorDelayLine::reset()
+{
+    if (buffer != nullptr)
+        std::fill(buffer, buffer + getRequiredStorageSize(), 0.0f);
+    writePos = 0;
+    validLength = totalSize;
+}
+
+void ResonatorDelayLine::copyStateFrom(const ResonatorDelayLine& other) noexcept
+{
+    jassert(totalSize == other.totalSize && buffer != nullptr && other.buffer != nullptr);
+    writePos = other.writePos;
+    validLength = other.validLength;
+
+    //only the valid samples, getReadPointer()[1 ... validLength], are copied, into both halves of the mirrored buffer,
+    //wrapping around the end of the first half at most once; right after a note-on, that is barely a block
+    int start = writePos + 1;
+    if (start >= totalSize) start -= totalSize;
+    const int firstRun = juce::jmin(validLength, totalSize - start);
+    std::copy(other.buffer + start, other.buffer + start + firstRun, buffer + start);
+    std::copy(other.buffer + start, other.buffer + start + firstRun, buffer + start + totalSize);
+    std::copy(other.buffer, other.buffer + (validLength - firstRun), buffer);
+    std::copy(other.buffer, other.buffer + (validLength - firstRun), buffer + totalSize);
+}
+
+void ResonatorDelayLine::makeReadable(float maxDelayInSamples) noexcept
+{
+    if (validLength >= totalSize || buffer == nullptr)
+        return;
+
+    //the interpolator reads up to two samples beyond the integer delay
+    const int required = juce::jmin(totalSize, static_cast<int>(std::ceil(maxDelayInSamples)) + 3);
+    if (required <= validLength)
+        return;
+
+    //zero getReadPointer()[validLength + 1 ... required] in both halves of the mirrored buffer,
+    //wrapping around the end of the first half at most once
+    int start = writePos + validLength + 1;
+    if (start >= totalSize) start -= totalSize;
+    const int numToClear = required - validLength;
+    const int firstRun = juce::jmin(numToClear, totalSize - start);
+    std::fill(buffer + start, buffer + start + firstRun, 0.0f);
+    std::fill(buffer + start + totalSize, buffer + start + totalSize + firstRun, 0.0f);
+    std::fill(buffer, buffer + (numToClear - firstRun), 0.0f);
+    std::fill(buffer + totalSize, buffer + totalSize + (numToClear - firstRun), 0.0f);
+    validLength = required;
+}
+
+void ResonatorDelayLine::popBlock(float* output, int numSamples) const noexcept
+{
+    jassert(canReadBlock(delay, numSamples));
+    int delayInt;
+    float delayFrac;
+    splitDelay(delay, delayInt, delayFrac);
+
+    const float d1 = delayFrac - 1.0f;
+    const float d2 = delayFrac - 2.0f;
+    const float d3 = delayFrac - 3.0f;
+    const float c1 = -d1 * d2 * d3 / 6.0f;
+    const float c2 = d2 * d3 * 0.5f;
+    const float c3 = -d1 * d3 * 0.5f;
+    const float c4 = d1 * d2 / 6.0f;
+
+    //the read head moves back by one sample for every sample pushed,
+    //so sample i of the block reads the taps starting at x[-i]
+    const float* x = getReadPointer() + delayInt;
+    for (int i = 0; i < numSamples; i++)
+    {
+        output[i] = x[-i] * c1 + delayFrac * (x[1 - i] * c2 + x[2 - i] * c3 + x[3 - i] * c4);
+    }
+}
+
+void ResonatorDelayLine::popBlock(float* output, const float* delays, int numSamples) noexcept
+{
+    const float* readPointer = getReadPointer();
+    for (int i = 0; i < numSamples; i++)
+    {
+        setDelay(delays[i]);
+        jassert(canReadBlock(delay, numSamples));
+        output[i] = read(readPointer - i, delay);
+    }
+}
+
+void ResonatorDelayLine::pushBlock(const float* input, const float* feedback, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; i++)
+    {
+        pushSample(input[i] + feedback[i]);
+    }
+}
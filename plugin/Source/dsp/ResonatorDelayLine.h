@@ -0,0 +1,185 @@
+#ifndef RESONATORDELAYLINE_H
+#define RESONATORDELAYLINE_H
+
+#include <juce_dsp/juce_dsp.h>
+
+/**
+ * A single-channel fractional delay line with third-order Lagrange interpolation,
+ * used as the waveguide loop of each Resonator.
+ *
+ * Behaves exactly like chowdsp::DelayLine<float, Lagrange3rd>, but the storage and the read/write heads are
+ * exposed so that the resonator bank can process many delay lines in lockstep (see ResonatorLaneKernel).
+ *
+ * The buffer is stored twice back-to-back (a "mirrored" buffer), newest sample first,
+ * so that the four interpolation taps are always contiguous in memory and never need to be wrapped.
+ * getReadPointer()[k] is the sample that was pushed k samples ago.
+ *
+ * The delay line does not own its storage: setMaximumDelayInSamples() only sizes it, and the (zeroed) memory is
+ * handed to it afterwards with setStorage(), typically from a DelayLineArena. Until then, it must not be processed.
+ *
+ * clearLazily() empties the delay line in constant time, so that a note-on does not have to zero the whole buffer:
+ * the delay line keeps track of how far back its contents are valid, and makeReadable() zeroes stale samples
+ * only once a read could actually reach them.
+ */
+class ResonatorDelayLine
+{
+public:
+    ResonatorDelayLine() = default;
+    explicit ResonatorDelayLine(int maximumDelayInSamples)
+    {
+        setMaximumDelayInSamples(maximumDelayInSamples);
+    }
+
+    /**
+     * Sizes the delay line, and drops its storage: setStorage() must be called again before it is processed.
+     */
+    void setMaximumDelayInSamples(int maximumDelayInSamples);
+
+    /**
+     * Hands the delay line getRequiredStorageSize() floats of zeroed memory, which must outlive it (or the next call).
+     */
+    void setStorage(float* newStorage) noexcept
+    {
+        buffer = newStorage;
+        writePos = 0;
+        validLength = totalSize;
+    }
+
+    size_t getRequiredStorageSize() const noexcept { return 2 * static_cast<size_t>(totalSize); }
+    bool hasStorage() const noexcept { return buffer != nullptr; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    /**
+     * Copies the contents and the write head of another delay line of the same size, but not its delay.
+     * Only the other's valid samples are copied, so this is cheap while it is still filling up after clearLazily().
+     */
+    void copyStateFrom(const ResonatorDelayLine& other) noexcept;
+
+    /**
+     * Empties the delay line in constant time. makeReadable() must be called before the next read.
+     */
+    void clearLazily() noexcept { validLength = 0; }
+
+    /**
+     * Zeroes whatever stale samples a read at up to maxDelayInSamples could reach.
+     * Reads stay valid as long as the delay does not exceed maxDelayInSamples,
+     * since every pushed sample extends the valid region by one.
+     */
+    void makeReadable(float maxDelayInSamples) noexcept;
+
+    void setDelay(float newDelayInSamples) noexcept
+    {
+        delay = juce::jlimit(0.0f, maximumDelay, newDelayInSamples);
+    }
+
+    float getDelay() const noexcept { return delay; }
+    float getMaximumDelayInSamples() const noexcept { return maximumDelay; }
+
+    /**
+     * Reads a single sample from the delay line, delay samples behind the write head.
+     * Must be followed by a call to pushSample() before the next popSample().
+     */
+    float popSample() noexcept
+    {
+        return read(getReadPointer(), delay);
+    }
+
+    /**
+     * Writes a single sample to the delay line and advances the write head.
+     */
+    void pushSample(float sample) noexcept
+    {
+        buffer[(size_t) writePos] = sample;
+        buffer[(size_t) (writePos + totalSize)] = sample;
+        writePos = (writePos == 0 ? totalSize : writePos) - 1;
+        //saturated, since a held note can push samples for longer than an int can count
+        if (validLength < totalSize) validLength++;
+    }
+
+    /**
+     * Reads a whole block at the current (constant) delay, as if popSample() and pushSample() were called
+     * alternately numSamples times. Only valid if canReadBlock(getDelay(), numSamples),
+     * i.e. if none of the samples read are pushed during the block itself.
+     * Must be followed by a call to pushBlock() with the same numSamples.
+     */
+    void popBlock(float* output, int numSamples) const noexcept;
+
+    /**
+     * As above, but with a per-sample delay. Every delay must satisfy canReadBlock().
+     * delays may point to the same array as output.
+     */
+    void popBlock(float* output, const float* delays, int numSamples) noexcept;
+
+    /**
+     * Pushes input[i] + feedback[i] for every sample in the block; the block equivalent of pushSample(input + feedback).
+     */
+    void pushBlock(const float* input, const float* feedback, int numSamples) noexcept;
+
+    /**
+     * Whether a block of numSamples can be read at the given delay before any of the block is pushed.
+     */
+    static bool canReadBlock(float delayInSamples, int numSamples) noexcept
+    {
+        return delayInSamples >= static_cast<float>(numSamples + 1);
+    }
+
+    /**
+     * Returns a pointer to the most recently pushed sample, minus one.
+     * In other words, getReadPointer()[k] is the sample pushed k samples ago, for 1 <= k <= totalSize.
+     */
+    const float* getReadPointer() const noexcept { return buffer + writePos; }
+
+    /**
+     * Splits a fractional delay into the integer tap offset and the fractional position used by
+     * the Lagrange interpolator, which reads taps [delayInt, delayInt + 3].
+     */
+    static void splitDelay(float delayInSamples, int& delayInt, float& delayFrac) noexcept
+    {
+        delayInt = static_cast<int>(delayInSamples);
+        delayFrac = delayInSamples - static_cast<float>(delayInt);
+        if (delayInt >= 1)
+        {
+            delayFrac += 1.0f;
+            delayInt -= 1;
+        }
+    }
+
+    /**
+     * Third-order Lagrange interpolation through the four taps starting at x[0].
+     */
+    static float interpolate(const float* x, float delayFrac) noexcept
+    {
+        const float d1 = delayFrac - 1.0f;
+        const float d2 = delayFrac - 2.0f;
+        const float d3 = delayFrac - 3.0f;
+
+        const float c1 = -d1 * d2 * d3 / 6.0f;
+        const float c2 = d2 * d3 * 0.5f;
+        const float c3 = -d1 * d3 * 0.5f;
+        const float c4 = d1 * d2 / 6.0f;
+
+        return x[0] * c1 + delayFrac * (x[1] * c2 + x[2] * c3 + x[3] * c4);
+    }
+
+    static float read(const float* readPointer, float delayInSamples) noexcept
+    {
+        int delayInt;
+        float delayFrac;
+        splitDelay(delayInSamples, delayInt, delayFrac);
+        return interpolate(readPointer + delayInt, delayFrac);
+    }
+
+    int getTotalSize() const noexcept { return totalSize; }
+
+private:
+    float* buffer = nullptr;
+    int totalSize = 0;
+    int writePos = 0;
+    int validLength = 0; //how many of the most recently pushed samples are valid, up to totalSize
+    float delay = 0.0f;
+    float maximumDelay = 0.0f;
+};
+
+#endif //RESONATORDELAYLINE_H
@@ -0,0 +1,126 @@
+#include "BlockTimeView.h"
+
+BlockTimeView::BlockTimeView(ResonariumProcessor& p) : proc(p), recorder(p.blockTimeRecorder)
+{
+    resetButton.onClick = [this]() { recorder.reset(); };
+    exportButton.onClick = [this]() { exportCsv(); };
+    addAndMakeVisible(resetButton);
+    addAndMakeVisible(exportButton);
+    startTimerHz(4);
+}
+
+void BlockTimeView::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    bounds.removeFromBottom(28); //buttons
+
+    const auto numBlocks = recorder.getNumBlocks();
+    const auto numOverruns = recorder.getNumOverruns();
+    const double budget = recorder.getBudgetMicroseconds();
+    auto millis = [](double microseconds) { return juce::String(microseconds / 1000.0, 2) + " ms"; };
+
+    g.setFont(juce::FontOptions(12.0f));
+    g.setColour(juce::Colours::white);
+    g.drawText("Blocks: " + juce::String(numBlocks) + "   Overruns: " + juce::String(numOverruns),
+               bounds.removeFromTop(14), juce::Justification::centredLeft, true);
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.drawText("Worst: " + millis(recorder.getMaxMicroseconds()) + "   Budget: " + millis(budget),
+               bounds.removeFromTop(14), juce::Justification::centredLeft, true);
+    bounds.removeFromTop(6);
+
+    //histogram, from the first bin up to whichever is further along: the slowest block, or a little past the budget
+    auto histogramArea = bounds.removeFromTop(100).toFloat();
+    int budgetBin = 0;
+    while (budgetBin + 1 < BlockTimeRecorder::numBins && BlockTimeRecorder::getBinLowerEdge(budgetBin + 1) <= budget)
+        budgetBin++;
+    int lastBin = juce::jmin(BlockTimeRecorder::numBins - 1, budgetBin + BlockTimeRecorder::binsPerOctave);
+    juce::int64 maxCount = 0;
+    for (int b = 0; b < BlockTimeRecorder::numBins; b++)
+    {
+        const auto count = recorder.getBinCount(b);
+        if (count > 0) lastBin = juce::jmax(lastBin, b);
+        maxCount = juce::jmax(maxCount, count);
+    }
+
+    g.setColour(juce::Colours::white.withAlpha(0.2f));
+    g.drawRect(histogramArea, 1.0f);
+    const float barWidth = histogramArea.getWidth() / static_cast<float>(lastBin + 1);
+    for (int b = 0; b <= lastBin && maxCount > 0; b++)
+    {
+        const auto count = recorder.getBinCount(b);
+        if (count == 0) continue;
+
+        //counts span many orders of magnitude, so the bars are on a log scale to keep rare slow blocks visible
+        const float height = static_cast<float>(std::log1p(static_cast<double>(count)) / std::log1p(static_cast<double>(maxCount)))
+            * histogramArea.getHeight();
+        const bool overBudget = BlockTimeRecorder::getBinUpperEdge(b) > budget;
+        g.setColour(overBudget ? juce::Colours::red.withAlpha(0.8f) : juce::Colours::white.withAlpha(0.7f));
+        g.fillRect(histogramArea.getX() + b * barWidth, histogramArea.getBottom() - height,
+                   juce::jmax(1.0f, barWidth - 1.0f), height);
+    }
+    if (budget > 0.0)
+    {
+        g.setColour(juce::Colours::red);
+        g.drawVerticalLine(juce::roundToInt(histogramArea.getX() + (budgetBin + 1) * barWidth),
+                           histogramArea.getY(), histogramArea.getBottom());
+    }
+    bounds.removeFromTop(6);
+
+    //latest overruns, newest first
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    g.drawText("Latest overruns", bounds.removeFromTop(14), juce::Justification::centredLeft, true);
+    const auto overruns = recorder.getOverruns();
+    g.setColour(juce::Colours::white);
+    for (int i = 0; i < juce::jmin(maxOverrunsShown, static_cast<int>(overruns.size())); i++)
+    {
+        const auto& overrun = overruns[overruns.size() - 1 - static_cast<size_t>(i)];
+        juce::StringArray banks;
+        for (int b = 0; b < NUM_RESONATOR_BANKS; b++)
+            if ((overrun.enabledBanks >> b) & 1) banks.add(juce::String(b + 1));
+
+        g.drawText(juce::Time(overrun.time).toString(false, true, true, true) + "  "
+                   + millis(overrun.renderMicroseconds) + "  "
+                   + juce::String(overrun.numActiveVoices) + " voices  "
+                   + "banks " + (banks.isEmpty() ? juce::String("-") : banks.joinIntoString(",")) + "  "
+                   + getProgramName(proc, overrun.program),
+                   bounds.removeFromTop(14), juce::Justification::centredLeft, true);
+    }
+}
+
+juce::String BlockTimeView::getProgramName(ResonariumProcessor& processor, int program)
+{
+    //presets can be deleted after an overrun was recorded
+    if (program < 0 || program >= processor.getNumPrograms()) return {};
+    return processor.getProgramName(program);
+}
+
+void BlockTimeView::resized()
+{
+    auto buttons = getLocalBounds().removeFromBottom(24);
+    exportButton.setBounds(buttons.removeFromRight(90));
+    buttons.removeFromRight(10);
+    resetButton.setBounds(buttons.removeFromRight(80));
+}
+
+void BlockTimeView::exportCsv()
+{
+    auto chooser = std::make_shared<juce::FileChooser>(
+        "Export block render times...",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Resonarium Block Times.csv"),
+        "*.csv"
+    );
+
+    //the panel may be closed before the chooser is, so only the processor is captured
+    chooser->launchAsync(juce::FileBrowserComponent::saveMode |
+                         juce::FileBrowserComponent::canSelectFiles |
+                         juce::FileBrowserComponent::warnAboutOverwriting,
+        [&processor = proc, chooser](const juce::FileChooser& fc)
+        {
+            const auto file = fc.getResult();
+            if (file == juce::File()) return;
+            file.replaceWithText(processor.blockTimeRecorder.toCsv([&processor](int program)
+            {
+                return getProgramName(processor, program);
+            }));
+        });
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../PluginProcessor.h"
+
+/**
+ * Shows the histogram of block render times against the real-time budget, and the latest overruns
+ * with what was playing at the time. The whole record can be reset, or exported to CSV.
+ */
+class BlockTimeView : public juce::Component, private juce::Timer
+{
+public:
+    explicit BlockTimeView(ResonariumProcessor& processor);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    static constexpr int maxOverrunsShown = 12;
+
+private:
+    void timerCallback() override { repaint(); }
+    void exportCsv();
+    static juce::String getProgramName(ResonariumProcessor& processor, int program);
+
+    ResonariumProcessor& proc;
+    BlockTimeRecorder& recorder;
+    juce::TextButton resetButton{"Reset"};
+    juce::TextButton exportButton{"Export CSV"};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockTimeView)
+};
@@ -1212,6 +1212,11 @@ public:
         addControl(polyFXSwitch = new gin::Switch(globalParams.polyEffectChain), 1, 0);
         addControl(stereoResonatorsSwitch = new gin::Switch(globalParams.stereoResonators), 2, 0);
         addControl(numVoicesKnob = new gin::Knob(globalParams.numVoices), 3, 0);
+        addControl(multithreadedVoicesSwitch = new gin::Switch(globalParams.multithreadedVoices), 0, 1);
+        addControl(controlPeriodKnob = new gin::Knob(globalParams.controlPeriod), 1, 1);
+        addControl(bakeResonatorsSwitch = new gin::Switch(globalParams.bakeResonators), 2, 1);
+        addControl(voiceGovernorSwitch = new gin::Switch(globalParams.voiceGovernor), 0, 2);
+        addControl(cpuLimitKnob = new gin::Knob(globalParams.cpuLimit), 1, 2);
     }
 
     ResonariumProcessor& proc;
@@ -1221,6 +1226,11 @@ public:
     gin::Switch* polyFXSwitch = nullptr;
     gin::Switch* stereoResonatorsSwitch = nullptr;
     gin::Knob* numVoicesKnob = nullptr;
+    gin::Switch* multithreadedVoicesSwitch = nullptr;
+    gin::Knob* controlPeriodKnob = nullptr;
+    gin::Switch* bakeResonatorsSwitch = nullptr;
+    gin::Switch* voiceGovernorSwitch = nullptr;
+    gin::Knob* cpuLimitKnob = nullptr;
 };
 
 #endif //PANELS_H
@@ -1,7 +1,8 @@
 #include "SettingsPanel.h"
 
 SettingsPanel::SettingsPanel(ResonariumProcessor& processor, juce::Component* parent) 
-    : proc(processor), parentComponent(parent)
+    : proc(processor), parentComponent(parent), profilerView(processor.globalState.profiler),
+      blockTimeView(processor)
 {
     setName("Settings Panel");
     
@@ -45,13 +46,15 @@ SettingsPanel::SettingsPanel(ResonariumProcessor& processor, juce::Component* pa
     addAndMakeVisible(enableAnimationsToggle);
     addAndMakeVisible(uiScaleLabel);
     addAndMakeVisible(uiScaleSlider);
+    addAndMakeVisible(profilerView);
+    addAndMakeVisible(blockTimeView);
     addAndMakeVisible(closeButton);
     
     // Set look and feel from processor
     setLookAndFeel(processor.lf.get());
     
     // Set initial size
-    setSize(350, 220);
+    setSize(720, 260 + StageProfilerView::getIdealHeight());
 }
 
 SettingsPanel::~SettingsPanel()
@@ -83,6 +86,16 @@ void SettingsPanel::resized()
     // Title area
     bounds.removeFromTop(30); // Space for title
     
+    // Close button
+    closeButton.setBounds(bounds.removeFromBottom(30).withSizeKeepingCentre(120, 30));
+    
+    bounds.removeFromBottom(10); // spacing
+    
+    // Block render times, in their own column
+    blockTimeView.setBounds(bounds.removeFromRight(340));
+    
+    bounds.removeFromRight(20); // spacing
+    
     // Theme selector row
     auto themeRow = bounds.removeFromTop(24);
     themeLabel.setBounds(themeRow.removeFromLeft(80));
@@ -106,8 +119,8 @@ void SettingsPanel::resized()
     
     bounds.removeFromTop(20); // spacing
     
-    // Close button
-    closeButton.setBounds(bounds.removeFromTop(30).withSizeKeepingCentre(120, 30));
+    // Render stage timings
+    profilerView.setBounds(bounds.removeFromTop(StageProfilerView::getIdealHeight()));
 }
 
 void SettingsPanel::show()
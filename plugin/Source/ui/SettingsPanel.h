@@ -5,6 +5,8 @@
 #include <gin_graphics/images/gin_imageeffects.h>  // For applyStackBlur
 #include "../PluginProcessor.h"
 #include "ResonariumLookAndFeel.h"
+#include "StageProfilerView.h"
+#include "BlockTimeView.h"
 
 class SettingsPanel : public juce::Component
 {
@@ -32,6 +34,8 @@ private:
     juce::Slider uiScaleSlider;
     juce::Label uiScaleLabel;
     juce::TextButton closeButton{"Close"};
+    StageProfilerView profilerView;
+    BlockTimeView blockTimeView;
 
     // BlurryComp from gin::PluginAlertWindow
     class BlurryComp : public juce::Component
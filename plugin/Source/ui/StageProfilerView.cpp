@@ -0,0 +1,50 @@
+#include "StageProfilerView.h"
+
+StageProfilerView::StageProfilerView(StageProfiler& p) : profiler(p)
+{
+    resetButton.onClick = [this]() { profiler.reset(); };
+    addAndMakeVisible(resetButton);
+    startTimerHz(4);
+}
+
+void StageProfilerView::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    bounds.removeFromBottom(28); //reset button
+
+    g.setFont(juce::FontOptions(12.0f));
+    auto drawRow = [&](const juce::String& name, const juce::String& min, const juce::String& avg,
+                       const juce::String& max)
+    {
+        auto row = bounds.removeFromTop(rowHeight);
+        const int columnWidth = row.getWidth() / 6;
+        auto maxColumn = row.removeFromRight(columnWidth);
+        auto avgColumn = row.removeFromRight(columnWidth);
+        auto minColumn = row.removeFromRight(columnWidth);
+        g.drawText(name, row, juce::Justification::centredLeft, true);
+        g.drawText(min, minColumn, juce::Justification::centredRight, false);
+        g.drawText(avg, avgColumn, juce::Justification::centredRight, false);
+        g.drawText(max, maxColumn, juce::Justification::centredRight, false);
+    };
+
+    g.setColour(juce::Colours::white.withAlpha(0.6f));
+    drawRow("Stage (us per block)", "min", "avg", "max");
+
+    auto micros = [](double nanoseconds) { return juce::String(nanoseconds / 1000.0, 1); };
+    for (int s = 0; s < StageProfiler::numStages; s++)
+    {
+        const auto stage = static_cast<StageProfiler::Stage>(s);
+        const auto statistics = profiler.getStatistics(stage);
+        g.setColour(juce::Colours::white.withAlpha(statistics.numBlocks > 0 ? 1.0f : 0.4f));
+        if (statistics.numBlocks > 0)
+            drawRow(StageProfiler::getStageName(stage), micros(statistics.minNanoseconds),
+                    micros(statistics.averageNanoseconds), micros(statistics.maxNanoseconds));
+        else
+            drawRow(StageProfiler::getStageName(stage), "-", "-", "-");
+    }
+}
+
+void StageProfilerView::resized()
+{
+    resetButton.setBounds(getLocalBounds().removeFromBottom(24).removeFromRight(80));
+}
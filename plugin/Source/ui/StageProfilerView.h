@@ -0,0 +1,27 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include "../util/StageProfiler.h"
+
+/**
+ * Shows the minimum, average and maximum time per block of each render stage, refreshed a few times a second.
+ */
+class StageProfilerView : public juce::Component, private juce::Timer
+{
+public:
+    explicit StageProfilerView(StageProfiler& profiler);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+    static constexpr int rowHeight = 14;
+    static int getIdealHeight() { return (StageProfiler::numStages + 1) * rowHeight + 28; }
+
+private:
+    void timerCallback() override { repaint(); }
+
+    StageProfiler& profiler;
+    juce::TextButton resetButton{"Reset"};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageProfilerView)
+};
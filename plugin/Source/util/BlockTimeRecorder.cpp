@@ -0,0 +1,95 @@
+#include "BlockTimeRecorder.h"
+
+bool BlockTimeRecorder::addBlock(double renderSeconds, double budgetSeconds) noexcept
+{
+    if (resetRequested.exchange(false, std::memory_order_relaxed))
+    {
+        for (auto& bin : bins) bin.store(0, std::memory_order_relaxed);
+        numBlocks.store(0, std::memory_order_relaxed);
+        numOverruns.store(0, std::memory_order_release);
+        maxMicroseconds.store(0.0, std::memory_order_relaxed);
+    }
+
+    const double microseconds = renderSeconds * 1.0e6;
+    int bin = 0;
+    if (microseconds >= firstBinEdge)
+        bin = juce::jmin(numBins - 1, 1 + static_cast<int>(std::log2(microseconds / firstBinEdge) * binsPerOctave));
+    bins[static_cast<size_t>(bin)].fetch_add(1, std::memory_order_relaxed);
+    numBlocks.fetch_add(1, std::memory_order_relaxed);
+    if (microseconds > maxMicroseconds.load(std::memory_order_relaxed))
+        maxMicroseconds.store(microseconds, std::memory_order_relaxed);
+    budgetMicroseconds.store(budgetSeconds * 1.0e6, std::memory_order_relaxed);
+
+    return renderSeconds > budgetSeconds;
+}
+
+void BlockTimeRecorder::addOverrun(const Overrun& overrun) noexcept
+{
+    const juce::int64 index = numOverruns.load(std::memory_order_relaxed);
+    auto& slot = overruns[static_cast<size_t>(index % maxOverruns)];
+    slot.time.store(overrun.time, std::memory_order_relaxed);
+    slot.renderMicroseconds.store(overrun.renderMicroseconds, std::memory_order_relaxed);
+    slot.budgetMicroseconds.store(overrun.budgetMicroseconds, std::memory_order_relaxed);
+    slot.numActiveVoices.store(overrun.numActiveVoices, std::memory_order_relaxed);
+    slot.enabledBanks.store(overrun.enabledBanks, std::memory_order_relaxed);
+    slot.program.store(overrun.program, std::memory_order_relaxed);
+    numOverruns.store(index + 1, std::memory_order_release);
+}
+
+double BlockTimeRecorder::getBinLowerEdge(int bin) noexcept
+{
+    if (bin <= 0) return 0.0;
+    return firstBinEdge * std::exp2(static_cast<double>(bin - 1) / binsPerOctave);
+}
+
+std::vector<BlockTimeRecorder::Overrun> BlockTimeRecorder::getOverruns() const
+{
+    const juce::int64 count = getNumOverruns();
+    const juce::int64 first = juce::jmax(static_cast<juce::int64>(0), count - maxOverruns);
+    std::vector<Overrun> result;
+    result.reserve(static_cast<size_t>(count - first));
+    for (juce::int64 i = first; i < count; i++)
+    {
+        const auto& slot = overruns[static_cast<size_t>(i % maxOverruns)];
+        Overrun overrun;
+        overrun.time = slot.time.load(std::memory_order_relaxed);
+        overrun.renderMicroseconds = slot.renderMicroseconds.load(std::memory_order_relaxed);
+        overrun.budgetMicroseconds = slot.budgetMicroseconds.load(std::memory_order_relaxed);
+        overrun.numActiveVoices = slot.numActiveVoices.load(std::memory_order_relaxed);
+        overrun.enabledBanks = slot.enabledBanks.load(std::memory_order_relaxed);
+        overrun.program = slot.program.load(std::memory_order_relaxed);
+        result.push_back(overrun);
+    }
+    return result;
+}
+
+juce::String BlockTimeRecorder::toCsv(const std::function<juce::String(int)>& getProgramName) const
+{
+    juce::String csv;
+    csv << "bin_from_us,bin_to_us,blocks\n";
+    for (int b = 0; b < numBins; b++)
+    {
+        const double upper = getBinUpperEdge(b);
+        csv << juce::String(getBinLowerEdge(b), 1) << ","
+            << (std::isinf(upper) ? juce::String() : juce::String(upper, 1)) << ","
+            << juce::String(getBinCount(b)) << "\n";
+    }
+
+    csv << "\ntime,render_us,budget_us,active_voices,enabled_banks,preset\n";
+    for (const auto& overrun : getOverruns())
+    {
+        juce::StringArray banks;
+        for (int b = 0; b < 31; b++)
+            if ((overrun.enabledBanks >> b) & 1) banks.add(juce::String(b + 1));
+
+        //presets can have commas in their names, so quote them, doubling any quotes inside
+        const juce::String preset = getProgramName(overrun.program).replace("\"", "\"\"");
+        csv << juce::Time(overrun.time).toISO8601(true) << ","
+            << juce::String(overrun.renderMicroseconds, 1) << ","
+            << juce::String(overrun.budgetMicroseconds, 1) << ","
+            << juce::String(overrun.numActiveVoices) << ","
+            << banks.joinIntoString(" ") << ","
+            << "\"" << preset << "\"\n";
+    }
+    return csv;
+}
@@ -0,0 +1,90 @@
+#ifndef BLOCKTIMERECORDER_H
+#define BLOCKTIMERECORDER_H
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Always-on, lock-free record of how long each audio block took to render, for spotting patches that are too heavy to play live.
+ *
+ * Every block's wall-clock render time goes into a histogram with logarithmically spaced bins, binsPerOctave per octave:
+ * bin 0 holds everything below firstBinEdge microseconds, and the last bin everything above its lower edge.
+ * A block that takes longer than its real-time budget, i.e. its own length, is an overrun (an xrun, if the host
+ * had no slack to absorb it); the last maxOverruns of them are kept along with what was playing at the time.
+ *
+ * addBlock(), addOverrun() and the actual clearing after reset() happen on the audio thread; everything else is safe
+ * from any thread. Nothing on the audio thread allocates or locks. Reads are field by field, so one that races with
+ * the audio thread can see a half-written overrun once the ring wraps around, which is harmless for a readout.
+ */
+class BlockTimeRecorder
+{
+public:
+    static constexpr int numBins = 64;
+    static constexpr int binsPerOctave = 4;
+    static constexpr double firstBinEdge = 10.0; //upper edge of the first bin, in microseconds
+    static constexpr int maxOverruns = 128;
+
+    struct Overrun
+    {
+        juce::int64 time = 0; //wall-clock time, in milliseconds since the epoch
+        float renderMicroseconds = 0.0f;
+        float budgetMicroseconds = 0.0f;
+        int numActiveVoices = 0;
+        int enabledBanks = 0; //bit b is set if resonator bank b had any resonator enabled
+        int program = -1; //index of the preset that was loaded
+    };
+
+    /**
+     * Records one block. Returns true if it overran its budget, in which case the caller should describe it with addOverrun().
+     */
+    bool addBlock(double renderSeconds, double budgetSeconds) noexcept;
+    void addOverrun(const Overrun& overrun) noexcept;
+
+    /**
+     * Clears the histogram and the overruns, as of the next addBlock().
+     */
+    void reset() noexcept { resetRequested.store(true, std::memory_order_relaxed); }
+
+    static double getBinLowerEdge(int bin) noexcept;
+    static double getBinUpperEdge(int bin) noexcept
+    {
+        return bin + 1 < numBins ? getBinLowerEdge(bin + 1) : std::numeric_limits<double>::infinity();
+    }
+    juce::int64 getBinCount(int bin) const noexcept { return bins[static_cast<size_t>(bin)].load(std::memory_order_relaxed); }
+
+    juce::int64 getNumBlocks() const noexcept { return numBlocks.load(std::memory_order_relaxed); }
+    juce::int64 getNumOverruns() const noexcept { return numOverruns.load(std::memory_order_acquire); }
+    double getMaxMicroseconds() const noexcept { return maxMicroseconds.load(std::memory_order_relaxed); }
+    double getBudgetMicroseconds() const noexcept { return budgetMicroseconds.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the last overruns, at most maxOverruns of them, oldest first. Allocates, so not for the audio thread.
+     */
+    std::vector<Overrun> getOverruns() const;
+
+    /**
+     * Writes the histogram and the overruns as two CSV tables, separated by an empty line.
+     * @param getProgramName turns an overrun's program index into a preset name
+     */
+    juce::String toCsv(const std::function<juce::String(int)>& getProgramName) const;
+
+private:
+    struct OverrunSlot
+    {
+        std::atomic<juce::int64> time { 0 };
+        std::atomic<float> renderMicroseconds { 0.0f };
+        std::atomic<float> budgetMicroseconds { 0.0f };
+        std::atomic<int> numActiveVoices { 0 };
+        std::atomic<int> enabledBanks { 0 };
+        std::atomic<int> program { -1 };
+    };
+
+    std::array<std::atomic<juce::int64>, numBins> bins {};
+    std::array<OverrunSlot, maxOverruns> overruns;
+    std::atomic<juce::int64> numBlocks { 0 };
+    std::atomic<juce::int64> numOverruns { 0 }; //ever recorded since the last reset; the ring holds the last maxOverruns
+    std::atomic<double> maxMicroseconds { 0.0 };
+    std::atomic<double> budgetMicroseconds { 0.0 }; //of the last block
+    std::atomic<bool> resetRequested { false };
+};
+
+#endif //BLOCKTIMERECORDER_H
@@ -0,0 +1,65 @@
+#ifndef INLINEARRAY_H
+#define INLINEARRAY_H
+
+#include <juce_core/juce_core.h>
+
+/**
+ * A fixed-capacity array whose objects are constructed in place, back-to-back in one cache-line-aligned block
+ * inside the owner, instead of each living in its own heap allocation as in a juce::OwnedArray.
+ *
+ * Used for the DSP objects of a voice (resonator banks, resonators, exciters), so that a voice's whole DSP state
+ * is one contiguous allocation. Like OwnedArray, indexing returns a pointer and iteration yields pointers,
+ * so call sites read the same.
+ */
+template <typename ElementType, int capacity>
+class InlineArray
+{
+public:
+    InlineArray() = default;
+    ~InlineArray() { clear(); }
+
+    /**
+     * Constructs a new element at the end of the array from the given arguments, and returns it.
+     */
+    template <typename... Args>
+    ElementType* add(Args&&... args)
+    {
+        jassert(numElements < capacity);
+        auto* element = new (storage + static_cast<size_t>(numElements) * sizeof(ElementType))
+            ElementType(std::forward<Args>(args)...);
+        pointers[static_cast<size_t>(numElements++)] = element;
+        return element;
+    }
+
+    /**
+     * Destroys every element, last to first.
+     */
+    void clear()
+    {
+        while (numElements > 0)
+        {
+            pointers[static_cast<size_t>(--numElements)]->~ElementType();
+        }
+    }
+
+    ElementType* operator[](int index) const noexcept
+    {
+        jassert(juce::isPositiveAndBelow(index, numElements));
+        return pointers[static_cast<size_t>(index)];
+    }
+
+    int size() const noexcept { return numElements; }
+    ElementType* const* begin() const noexcept { return pointers.data(); }
+    ElementType* const* end() const noexcept { return pointers.data() + numElements; }
+
+private:
+    static constexpr size_t alignment = alignof(ElementType) > 64 ? alignof(ElementType) : 64;
+
+    alignas(alignment) std::byte storage[sizeof(ElementType) * static_cast<size_t>(capacity)];
+    std::array<ElementType*, static_cast<size_t>(capacity)> pointers {};
+    int numElements = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(InlineArray)
+};
+
+#endif //INLINEARRAY_H
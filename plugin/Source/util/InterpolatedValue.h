@@ -44,6 +44,17 @@ public:
         filterState = value;
     }
 
+    /**
+     * Moves the current value, keeping the target, so that the remaining samples of the ramp lead from the new value.
+     */
+    void setCurrentValue(float value)
+    {
+        current = value;
+        filterState = value;
+        noop = current == target;
+        increment = samplesRemaining > 0 ? (target - current) / static_cast<float>(samplesRemaining) : 0.0f;
+    }
+
     //Resets the state of the InterpolatedParameter.
     //When setTargetValue is called for the first time after a reset,
     //the InterpolatedParameter will snap to the target value.
@@ -69,6 +80,12 @@ public:
         return current;
     }
 
+    float getCurrentValue() const { return current; }
+    float getTargetValue() const { return target; }
+
+    //Returns true if nextValue() will return the same value until the next call to setTargetValue().
+    bool isStatic() const { return noop; }
+
 private:
     inline float processOnePole(float input)
     {
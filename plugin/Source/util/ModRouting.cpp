@@ -0,0 +1,67 @@
+#include "ModRouting.h"
+
+ModRouting::~ModRouting()
+{
+    if (modMatrix != nullptr)
+    {
+        modMatrix->removeListener(this);
+    }
+}
+
+void ModRouting::setPolyphony(gin::Parameter* parameter, Polyphony polyphony)
+{
+    jassert(modMatrix == nullptr); //the classification is fixed once attached
+    const int modIndex = parameter->getModIndex();
+    jassert(modIndex >= 0);
+
+    if (modIndex >= static_cast<int>(polyphonyByModIndex.size()))
+    {
+        parametersByModIndex.resize(static_cast<size_t>(modIndex + 1), nullptr);
+        polyphonyByModIndex.resize(static_cast<size_t>(modIndex + 1), Polyphony::poly);
+    }
+    parametersByModIndex[static_cast<size_t>(modIndex)] = parameter;
+    polyphonyByModIndex[static_cast<size_t>(modIndex)] = polyphony;
+}
+
+ModRouting::Polyphony ModRouting::getPolyphony(const gin::Parameter* parameter) const
+{
+    const auto index = static_cast<size_t>(parameter->getModIndex());
+    return index < polyphonyByModIndex.size() ? polyphonyByModIndex[index] : Polyphony::poly;
+}
+
+void ModRouting::attach(gin::ModMatrix& matrix)
+{
+    jassert(modMatrix == nullptr);
+    polyModulated = std::vector<std::atomic<bool>>(polyphonyByModIndex.size());
+    modMatrix = &matrix;
+    modMatrix->addListener(this);
+    refresh();
+}
+
+void ModRouting::refresh()
+{
+    if (modMatrix == nullptr)
+        return;
+
+    for (size_t i = 0; i < parametersByModIndex.size(); i++)
+    {
+        bool poly = false;
+        if (parametersByModIndex[i] != nullptr && polyphonyByModIndex[i] == Polyphony::poly)
+        {
+            for (auto& [source, depth] : modMatrix->getModDepths(gin::ModDstId(static_cast<int>(i))))
+            {
+                if (modMatrix->getModSrcPoly(source))
+                {
+                    poly = true;
+                    break;
+                }
+            }
+        }
+        polyModulated[i].store(poly, std::memory_order_relaxed);
+    }
+}
+
+void ModRouting::modMatrixChanged()
+{
+    refresh();
+}
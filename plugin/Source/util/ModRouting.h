@@ -0,0 +1,64 @@
+#ifndef MODROUTING_H
+#define MODROUTING_H
+
+#include <gin_plugin/gin_plugin.h>
+
+/**
+ * Tracks, for every modulation destination, whether it needs to be evaluated per voice.
+ *
+ * Each parameter is classified as mono or poly when it is added to the mod matrix. Mono parameters apply to the synth
+ * as a whole (e.g. the macros) and are never evaluated per voice. A poly parameter is demoted to the mono path
+ * for as long as no poly source is routed to it, since all voices would then compute the same value.
+ *
+ * The routing is re-examined whenever the mod matrix changes, off the audio thread; the audio thread only reads flags.
+ */
+class ModRouting : private gin::ModMatrix::Listener
+{
+public:
+    enum class Polyphony
+    {
+        mono,
+        poly
+    };
+
+    ModRouting() = default;
+    ~ModRouting() override;
+
+    /**
+     * Records the classification of a parameter. Call right after adding the parameter to the mod matrix.
+     */
+    void setPolyphony(gin::Parameter* parameter, Polyphony polyphony);
+    Polyphony getPolyphony(const gin::Parameter* parameter) const;
+
+    /**
+     * Starts following the routing of the given mod matrix. Call once, after all parameters have been classified
+     * and the mod matrix has been built.
+     */
+    void attach(gin::ModMatrix& matrix);
+
+    /**
+     * Re-examines the routing of every parameter. Called automatically when the mod matrix changes;
+     * call it by hand after loading state, which does not always notify the listeners.
+     */
+    void refresh();
+
+    /**
+     * Returns true if the parameter is poly and at least one poly source is routed to it,
+     * i.e. if its value can differ between voices.
+     */
+    bool isPolyModulated(const gin::Parameter* parameter) const noexcept
+    {
+        const auto index = static_cast<size_t>(parameter->getModIndex());
+        return index < polyModulated.size() && polyModulated[index].load(std::memory_order_relaxed);
+    }
+
+private:
+    void modMatrixChanged() override;
+
+    gin::ModMatrix* modMatrix = nullptr;
+    std::vector<gin::Parameter*> parametersByModIndex;
+    std::vector<Polyphony> polyphonyByModIndex;
+    std::vector<std::atomic<bool>> polyModulated; //indexed by mod index, sized once in attach()
+};
+
+#endif //MODROUTING_H
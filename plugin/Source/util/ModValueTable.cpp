@@ -0,0 +1,62 @@
+#include "ModValueTable.h"
+
+ModValueTable::Handle ModValueTable::addParameter(gin::Parameter* parameter)
+{
+    const int modIndex = parameter->getModIndex();
+    jassert(modIndex >= 0); //only modulation destinations can be read through the table
+
+    if (modIndex >= static_cast<int>(handlesByModIndex.size()))
+    {
+        handlesByModIndex.resize(static_cast<size_t>(modIndex + 1), -1);
+    }
+
+    auto& handle = handlesByModIndex[static_cast<size_t>(modIndex)];
+    if (handle < 0)
+    {
+        handle = static_cast<Handle>(entries.size());
+        entries.push_back({parameter});
+        values.resize(2 * entries.size(), 0.0f);
+    }
+    return handle;
+}
+
+void ModValueTable::prepare(double sampleRate, int maximumBlockSize)
+{
+    settlingSamples = static_cast<int>(std::ceil(PARAMETER_SMOOTHING_TIME * sampleRate)) + maximumBlockSize;
+}
+
+void ModValueTable::update(gin::ModMatrix& modMatrix, const ModRouting& routing, gin::ModVoice& voice, int numSamples)
+{
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        auto& entry = entries[i];
+        const float value = entry.parameter->getValue();
+        const bool modulated = modMatrix.isModulated(gin::ModDstId(entry.parameter->getModIndex()));
+        //a value glides back once its modulation is removed, much as it does after a change
+        if (value != entry.lastValue || (entry.modulated && !modulated)) entry.samplesSinceChange = 0;
+        const bool settling = entry.samplesSinceChange >= 0;
+        if (settling)
+        {
+            //the tick that comes once the smoothing is over reads the final value, and is the last one
+            entry.samplesSinceChange = entry.samplesSinceChange >= settlingSamples
+                ? -1
+                : entry.samplesSinceChange + numSamples;
+        }
+
+        if (modulated || settling)
+        {
+            if (routing.isPolyModulated(entry.parameter))
+            {
+                values[2 * i] = voice.getValue(entry.parameter, 0);
+                values[2 * i + 1] = voice.getValue(entry.parameter, 1);
+            }
+            else
+            {
+                values[2 * i] = modMatrix.getValue(entry.parameter, 0);
+                values[2 * i + 1] = modMatrix.getValue(entry.parameter, 1);
+            }
+            entry.lastValue = value;
+            entry.modulated = modulated;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef MODVALUETABLE_H
+#define MODVALUETABLE_H
+
+#include <gin_plugin/gin_plugin.h>
+#include "../defines.h"
+#include "ModRouting.h"
+
+/**
+ * A voice's flat table of final, modulated parameter values, one per parameter and channel.
+ *
+ * DSP components register the parameters they read once, in prepare(), and keep the returned Handle;
+ * afterwards, reading a value is an array lookup instead of a call to ModVoice::getValue(),
+ * which evaluates the modulation routing on every call.
+ *
+ * The table is refreshed once per control tick by update(). Only the parameters that have modulation routed to them
+ * are evaluated on every tick; the others are only evaluated again when their own value has changed, and then
+ * on every tick until the mod matrix has finished smoothing it to its new value.
+ * Parameters without poly modulation routed to them (see ModRouting) are evaluated on the cheaper mono path,
+ * which skips the voice's sources and smoothers.
+ */
+class ModValueTable
+{
+public:
+    using Handle = int;
+
+    /**
+     * Adds a parameter to the table, and returns its handle. Adding a parameter twice returns the same handle.
+     * Allocates, so it must be called off the audio thread.
+     */
+    Handle addParameter(gin::Parameter* parameter);
+
+    /**
+     * Sets how long a changed parameter keeps being evaluated: the smoothing time, plus a block,
+     * since the mod matrix's smoothers only advance at the end of each block.
+     */
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    /**
+     * Brings every value up to date. Call once per control tick, after the voice's modulation sources have been set.
+     * @param numSamples the number of samples until the next call.
+     */
+    void update(gin::ModMatrix& modMatrix, const ModRouting& routing, gin::ModVoice& voice, int numSamples);
+
+    float get(Handle handle, int channel = 0) const noexcept
+    {
+        return values[static_cast<size_t>(handle * 2 + channel)];
+    }
+
+    int getNumParameters() const noexcept { return static_cast<int>(entries.size()); }
+
+private:
+    struct Entry
+    {
+        gin::Parameter* parameter = nullptr;
+        float lastValue = -1.0f; //the parameter's normalised, unmodulated value when it was last evaluated
+        bool modulated = false; //whether it had modulation routed to it when it was last evaluated
+        int samplesSinceChange = -1; //since lastValue changed, while it is still being smoothed; -1 once settled
+    };
+
+    std::vector<Entry> entries;
+    std::vector<float> values; //two per entry: left channel, then right channel
+    std::vector<Handle> handlesByModIndex; //-1 for parameters that are not in the table
+    int settlingSamples = 0;
+};
+
+#endif //MODVALUETABLE_H
@@ -0,0 +1,130 @@
+#include "RealtimeThreadPool.h"
+
+thread_local bool RealtimeThreadPool::isInsideJob = false;
+
+RealtimeThreadPool::Worker::Worker(RealtimeThreadPool& pool, int index) :
+    juce::Thread("Resonarium Worker " + juce::String(index)), pool(pool)
+{
+}
+
+void RealtimeThreadPool::Worker::run()
+{
+    juce::uint32 seenGeneration = pool.generation.load(std::memory_order_acquire);
+    while (!threadShouldExit())
+    {
+        if (joinedWorkgroup != pool.workgroupVersion.load(std::memory_order_acquire)) updateWorkgroup();
+        pool.generation.wait(seenGeneration, std::memory_order_acquire);
+        seenGeneration = pool.generation.load(std::memory_order_acquire);
+        if (threadShouldExit()) break;
+        pool.activeWorkers.fetch_add(1);
+        pool.runAvailableJobs();
+        pool.activeWorkers.fetch_sub(1);
+    }
+    workgroupToken = {}; //a workgroup is left by the thread that joined it
+}
+
+void RealtimeThreadPool::Worker::updateWorkgroup()
+{
+    const juce::uint32 version = pool.workgroupVersion.load(std::memory_order_acquire);
+    const juce::SpinLock::ScopedTryLockType lock(pool.workgroupLock);
+    if (!lock.isLocked()) return;
+    workgroupToken = {};
+    if (pool.workgroup) pool.workgroup.join(workgroupToken);
+    joinedWorkgroup = version;
+}
+
+RealtimeThreadPool::RealtimeThreadPool(int numWorkers, const juce::Thread::RealtimeOptions& options)
+{
+    for (int i = 0; i < numWorkers; i++)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+        if (!worker->startRealtimeThread(options) && !worker->isThreadRunning())
+            worker->startThread(juce::Thread::Priority::highest);
+    }
+}
+
+RealtimeThreadPool::~RealtimeThreadPool()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+    }
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+    for (auto* worker : workers)
+    {
+        worker->stopThread(1000);
+    }
+    workers.clear(true);
+}
+
+void RealtimeThreadPool::setWorkgroup(const juce::AudioWorkgroup& newWorkgroup)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(workgroupLock);
+        workgroup = newWorkgroup;
+    }
+    workgroupVersion.fetch_add(1, std::memory_order_release);
+    //the workers join it before they next sleep
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+}
+
+int RealtimeThreadPool::getDefaultNumWorkers()
+{
+    return juce::jmax(0, juce::SystemStats::getNumCpus() - 1);
+}
+
+void RealtimeThreadPool::run(int numJobs, JobFunction function, void* context)
+{
+    if (numJobs <= 0) return;
+
+    bool expected = false;
+    if (numJobs == 1 || workers.isEmpty() || isInsideJob || !busy.compare_exchange_strong(expected, true))
+    {
+        for (int i = 0; i < numJobs; i++)
+        {
+            function(context, i);
+        }
+        return;
+    }
+
+    //publish the batch; the release store to nextJob makes the job fields visible to whoever claims a job
+    jobFunction = function;
+    jobContext = context;
+    numJobsInBatch.store(numJobs, std::memory_order_relaxed);
+    remainingJobs.store(numJobs, std::memory_order_relaxed);
+    nextJob.store(0, std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    runAvailableJobs();
+
+    //wait for jobs that were claimed by workers; spin briefly, then yield
+    for (int spins = 0; remainingJobs.load(std::memory_order_acquire) > 0; spins++)
+    {
+        if (spins > 64) std::this_thread::yield();
+    }
+
+    //close the batch, then wait for any worker that woke up late and is still looking at it,
+    //so that nobody can mistake a stale job index for one of the next batch
+    nextJob.store(noMoreJobs);
+    while (activeWorkers.load() > 0)
+    {
+        std::this_thread::yield();
+    }
+    busy.store(false, std::memory_order_release);
+}
+
+void RealtimeThreadPool::runAvailableJobs()
+{
+    isInsideJob = true;
+    for (;;)
+    {
+        const int jobIndex = nextJob.fetch_add(1, std::memory_order_acquire);
+        if (jobIndex >= numJobsInBatch.load(std::memory_order_relaxed)) break;
+        jobFunction(jobContext, jobIndex);
+        remainingJobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    isInsideJob = false;
+}
@@ -0,0 +1,105 @@
+#ifndef REALTIMETHREADPOOL_H
+#define REALTIMETHREADPOOL_H
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * A fork-join pool of pre-spawned worker threads that is safe to use from the audio thread.
+ *
+ * run() hands a batch of independent jobs to the workers and returns once all of them are done.
+ * The calling thread participates in the batch, so a batch never waits on a worker that has not woken up yet.
+ * Jobs are claimed through a single atomic counter: whichever thread is free takes the next unclaimed job.
+ * Nothing is allocated and no locks are taken after construction;
+ * idle workers sleep on an atomic and are woken with a notify.
+ *
+ * Since the audio thread waits on the workers, they run at real-time priority, and join the host's audio workgroup
+ * where there is one (see setWorkgroup()), so that the OS schedules them like the audio thread itself.
+ *
+ * Batches do not nest: a run() issued from inside a job, or while another thread's batch is in flight,
+ * simply runs its jobs inline on the calling thread.
+ */
+class RealtimeThreadPool
+{
+public:
+    using JobFunction = void (*)(void* context, int jobIndex);
+
+    /**
+     * @param numWorkers the number of threads to spawn in addition to the calling thread.
+     * @param options the real-time scheduling of the workers; where real-time threads are not permitted,
+     * they fall back to the highest ordinary priority.
+     */
+    explicit RealtimeThreadPool(int numWorkers, const juce::Thread::RealtimeOptions& options = {});
+    ~RealtimeThreadPool();
+
+    /**
+     * Returns a sensible number of workers for this machine: one fewer than the number of cores,
+     * leaving a core for the audio thread itself.
+     */
+    static int getDefaultNumWorkers();
+
+    int getNumWorkers() const noexcept { return static_cast<int>(workers.size()); }
+
+    /**
+     * Calls job(i) for every i in [0, numJobs), spread across the workers and the calling thread,
+     * and returns once every call has returned. The jobs must be independent of each other.
+     */
+    template <typename Job>
+    void run(int numJobs, Job& job)
+    {
+        run(numJobs, [](void* context, int jobIndex) { (*static_cast<Job*>(context))(jobIndex); }, &job);
+    }
+
+    void run(int numJobs, JobFunction function, void* context);
+
+    /**
+     * Sets the audio workgroup of the thread that calls run(), which every worker joins when it next wakes up.
+     * An empty workgroup makes them leave it again.
+     */
+    void setWorkgroup(const juce::AudioWorkgroup& newWorkgroup);
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(RealtimeThreadPool& pool, int index);
+        void run() override;
+
+    private:
+        /**
+         * Joins the pool's current workgroup, unless setWorkgroup() is busy with it, in which case it is tried again
+         * at the next wake up.
+         */
+        void updateWorkgroup();
+
+        RealtimeThreadPool& pool;
+        juce::WorkgroupToken workgroupToken;
+        juce::uint32 joinedWorkgroup = 0; //the workgroupVersion that the worker has joined
+    };
+
+    /**
+     * Claims and runs jobs from the current batch until none are left.
+     */
+    void runAvailableJobs();
+
+    static constexpr int noMoreJobs = 1 << 30;
+
+    juce::OwnedArray<Worker> workers;
+    std::atomic<bool> busy { false };
+    std::atomic<juce::uint32> generation { 0 };
+    std::atomic<int> nextJob { noMoreJobs };
+    std::atomic<int> remainingJobs { 0 };
+    std::atomic<int> numJobsInBatch { 0 };
+    std::atomic<int> activeWorkers { 0 }; //workers currently claiming jobs
+    JobFunction jobFunction = nullptr;
+    void* jobContext = nullptr;
+    juce::SpinLock workgroupLock;
+    juce::AudioWorkgroup workgroup; //guarded by workgroupLock
+    std::atomic<juce::uint32> workgroupVersion { 0 };
+
+    static thread_local bool isInsideJob;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeThreadPool)
+};
+
+#endif //REALTIMETHREADPOOL_H
@@ -0,0 +1,68 @@
+#include "StageProfiler.h"
+
+const char* StageProfiler::getStageName(Stage stage) noexcept
+{
+    switch (stage)
+    {
+    case processBlock: return "Process Block";
+    case synthRender: return "Synth";
+    case voiceRender: return "Voices";
+    case voiceParameters: return "Voice Parameters";
+    case exciters: return "Exciters";
+    case resonatorBank1: return "Resonator Bank 1";
+    case resonatorBank2: return "Resonator Bank 2";
+    case resonatorBank3: return "Resonator Bank 3";
+    case resonatorBank4: return "Resonator Bank 4";
+    case filter1: return "Filter 1";
+    case chorus: return "Chorus";
+    case phaser: return "Phaser";
+    case distortion: return "Distortion";
+    case multiAmp: return "Amp";
+    case delay: return "Delay";
+    case compressor: return "Compressor";
+    case reverb: return "Reverb";
+    case filter2: return "Filter 2";
+    case numStages: break;
+    }
+    return "";
+}
+
+void StageProfiler::finishBlock() noexcept
+{
+    const bool clear = resetRequested.exchange(false, std::memory_order_relaxed);
+    for (size_t s = 0; s < accumulators.size(); s++)
+    {
+        auto& accumulator = accumulators[s];
+        if (clear)
+        {
+            accumulator.numBlocks.store(0, std::memory_order_relaxed);
+            accumulator.totalTicks.store(0, std::memory_order_relaxed);
+        }
+
+        const juce::int64 ticks = blockTicks[s].exchange(0, std::memory_order_relaxed);
+        if (ticks == 0) continue;
+
+        const juce::int64 numBlocks = accumulator.numBlocks.load(std::memory_order_relaxed);
+        if (numBlocks == 0 || ticks < accumulator.minTicks.load(std::memory_order_relaxed))
+            accumulator.minTicks.store(ticks, std::memory_order_relaxed);
+        if (numBlocks == 0 || ticks > accumulator.maxTicks.load(std::memory_order_relaxed))
+            accumulator.maxTicks.store(ticks, std::memory_order_relaxed);
+        accumulator.totalTicks.fetch_add(ticks, std::memory_order_relaxed);
+        accumulator.numBlocks.store(numBlocks + 1, std::memory_order_release);
+    }
+}
+
+StageProfiler::Statistics StageProfiler::getStatistics(Stage stage) const noexcept
+{
+    const auto& accumulator = accumulators[static_cast<size_t>(stage)];
+    Statistics statistics;
+    statistics.numBlocks = accumulator.numBlocks.load(std::memory_order_acquire);
+    if (statistics.numBlocks == 0) return statistics;
+
+    const double nanosecondsPerTick = 1.0e9 / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    statistics.minNanoseconds = static_cast<double>(accumulator.minTicks.load(std::memory_order_relaxed)) * nanosecondsPerTick;
+    statistics.maxNanoseconds = static_cast<double>(accumulator.maxTicks.load(std::memory_order_relaxed)) * nanosecondsPerTick;
+    statistics.averageNanoseconds = static_cast<double>(accumulator.totalTicks.load(std::memory_order_relaxed))
+        * nanosecondsPerTick / static_cast<double>(statistics.numBlocks);
+    return statistics;
+}
@@ -0,0 +1,113 @@
+#ifndef STAGEPROFILER_H
+#define STAGEPROFILER_H
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Always-on, lock-free timing of the main stages of rendering, per audio block.
+ *
+ * While a block renders, each stage's time is summed over every call and every thread (e.g. the voice stage across
+ * all voices); at the end of the block, just before processBlock returns, finishBlock() folds each stage's total
+ * into its running minimum, average and maximum per block. Blocks in which a stage did not run at all
+ * (a disabled effect, no active voices) are left out of that stage's statistics.
+ *
+ * add() and ScopedStage are safe from any render thread, getStatistics() and reset() from any thread at all;
+ * only finishBlock() is reserved for the audio thread. Nothing allocates or locks. Statistics are read field by field,
+ * so a read that races with finishBlock() can mix two consecutive blocks, which is harmless for a readout.
+ *
+ * This complements the Perfetto trace events at the same places (each effect's named after its stage),
+ * which need a special build, but show every single call on a timeline.
+ */
+class StageProfiler
+{
+public:
+    enum Stage
+    {
+        processBlock,
+        synthRender,
+        voiceRender,
+        voiceParameters,
+        exciters,
+        resonatorBank1,
+        resonatorBank2,
+        resonatorBank3,
+        resonatorBank4,
+        filter1,
+        chorus,
+        phaser,
+        distortion,
+        multiAmp,
+        delay,
+        compressor,
+        reverb,
+        filter2,
+        numStages
+    };
+
+    struct Statistics
+    {
+        double minNanoseconds = 0.0;
+        double averageNanoseconds = 0.0;
+        double maxNanoseconds = 0.0;
+        juce::int64 numBlocks = 0;
+    };
+
+    /**
+     * Times the enclosing scope as part of a stage. Does nothing if the profiler is null.
+     */
+    class ScopedStage
+    {
+    public:
+        ScopedStage(StageProfiler* profiler, Stage stage) noexcept :
+            profiler(profiler), stage(stage),
+            start(profiler != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedStage()
+        {
+            if (profiler != nullptr) profiler->add(stage, juce::Time::getHighResolutionTicks() - start);
+        }
+
+    private:
+        StageProfiler* profiler;
+        Stage stage;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    static const char* getStageName(Stage stage) noexcept;
+
+    void add(Stage stage, juce::int64 ticks) noexcept
+    {
+        blockTicks[static_cast<size_t>(stage)].fetch_add(ticks, std::memory_order_relaxed);
+    }
+
+    /**
+     * Ends the current block. Call from the audio thread, once every render thread is done with the block.
+     */
+    void finishBlock() noexcept;
+
+    Statistics getStatistics(Stage stage) const noexcept;
+
+    /**
+     * Clears the statistics, as of the next finishBlock().
+     */
+    void reset() noexcept { resetRequested.store(true, std::memory_order_relaxed); }
+
+private:
+    struct Accumulator
+    {
+        std::atomic<juce::int64> minTicks { 0 };
+        std::atomic<juce::int64> maxTicks { 0 };
+        std::atomic<juce::int64> totalTicks { 0 };
+        std::atomic<juce::int64> numBlocks { 0 };
+    };
+
+    std::array<std::atomic<juce::int64>, numStages> blockTicks {}; //each stage's time so far in the current block
+    std::array<Accumulator, numStages> accumulators;
+    std::atomic<bool> resetRequested { false };
+};
+
+#endif //STAGEPROFILER_H
@@ -0,0 +1,29 @@
+# Renders the same preset twice through a single render worker, and checks that both files are identical,
+# i.e. that nothing from the first render leaks into the second one.
+#
+# Usage: cmake -DRENDER=<Resonarium_Render> -DPRESET=<preset.xml> -DMIDI=<file.mid> -DWORK_DIR=<dir> -P RenderDeterminism.cmake
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/presets" "${WORK_DIR}/output")
+# jobs run in file name order, so "A" is rendered first and "B" right after it, by the same worker
+configure_file("${PRESET}" "${WORK_DIR}/presets/A.xml" COPYONLY)
+configure_file("${PRESET}" "${WORK_DIR}/presets/B.xml" COPYONLY)
+
+execute_process(
+        COMMAND "${RENDER}" --preset "${WORK_DIR}/presets" --midi "${MIDI}" --output "${WORK_DIR}/output"
+                --threads 1 --tail 2
+        RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Resonarium_Render failed: ${result}")
+endif ()
+
+get_filename_component(midiName "${MIDI}" NAME_WE)
+execute_process(
+        COMMAND "${CMAKE_COMMAND}" -E compare_files
+                "${WORK_DIR}/output/A - ${midiName}.wav" "${WORK_DIR}/output/B - ${midiName}.wav"
+        RESULT_VARIABLE different
+)
+if (NOT different EQUAL 0)
+    message(FATAL_ERROR "Rendering the same preset twice through one worker gave different audio")
+endif ()
@@ -0,0 +1,42 @@
+"""
+Checks that an unmodulated parameter change reaches its new value once the mod matrix has smoothed it,
+rather than staying at whatever was read on the first block after the change.
+Run with the directory of the built resonarium module on PYTHONPATH.
+"""
+import unittest
+
+import numpy as np
+import resonarium
+
+
+def rms(audio):
+    return float(np.sqrt(np.mean(np.square(audio, dtype=np.float64))))
+
+
+class ParameterSmoothingTest(unittest.TestCase):
+    def setUp(self):
+        self.synth = resonarium.Resonarium()
+        #a sustained noise exciter keeps a single resonator ringing at a steady level
+        self.synth.set_param("noiseExciter0enabled", 1.0)
+        self.synth.set_param("noiseExciter0level", 0.01)
+        self.synth.set_param("noiseExciterEnv0sustain", 100.0)
+        self.synth.set_param("enabled wb0r0", 1.0)
+        self.sample_rate = int(self.synth.get_sample_rate())
+
+    def test_unmodulated_change_reaches_new_value(self):
+        sr = self.sample_rate
+        events = [
+            (0, "note_on", 0, 60, 100),
+            (sr, "param", "outputGain wb0", -40.0),
+        ]
+        audio = self.synth.render_events(events, num_samples=2 * sr)
+
+        before = rms(audio[:, sr // 2:sr])
+        after = rms(audio[:, 3 * sr // 2:])
+        self.assertGreater(before, 0.0)
+        change = 20.0 * np.log10(max(after, 1.0e-12) / before)
+        self.assertAlmostEqual(change, -40.0, delta=3.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,45 @@
+"""
+Checks that render_events rejects MIDI values outside of their ranges, and still renders valid events.
+Run with the directory of the built resonarium module on PYTHONPATH.
+"""
+import unittest
+
+import numpy as np
+import resonarium
+
+
+class RenderEventsTest(unittest.TestCase):
+    def setUp(self):
+        self.synth = resonarium.Resonarium()
+        self.num_samples = 4 * self.synth.get_block_size()
+
+    def assert_rejected(self, event):
+        with self.assertRaises(ValueError, msg=str(event)):
+            self.synth.render_events([event], num_samples=self.num_samples)
+
+    def test_rejects_out_of_range_midi(self):
+        self.assert_rejected((0, "note_on", 16, 60, 100))
+        self.assert_rejected((0, "note_on", -1, 60, 100))
+        self.assert_rejected((0, "note_on", 0, 128, 100))
+        self.assert_rejected((0, "note_on", 0, 60, 128))
+        self.assert_rejected((0, "note_off", 0, -1))
+        self.assert_rejected((0, "cc", 0, 128, 64))
+        self.assert_rejected((0, "cc", 0, 1, 128))
+        self.assert_rejected((0, "pitch_bend", 0, 16384))
+        self.assert_rejected((0, "pitch_bend", 0, -1))
+
+    def test_accepts_range_limits(self):
+        events = [
+            (0, "note_on", 15, 127, 127),
+            (1, "cc", 0, 127, 127),
+            (2, "pitch_bend", 0, 16383),
+            (3, "pitch_bend", 0, 0),
+            (4, "note_off", 15, 127),
+        ]
+        audio = self.synth.render_events(events, num_samples=self.num_samples)
+        self.assertEqual(audio.shape, (2, self.num_samples))
+        self.assertTrue(np.all(np.isfinite(audio)))
+
+
+if __name__ == "__main__":
+    unittest.main()